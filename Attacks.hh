@@ -0,0 +1,160 @@
+#ifndef __ATTACKS_H__
+#define __ATTACKS_H__
+
+#include "BoardGeometry.hh"
+#include "Magic.hh"
+
+#include <type_traits>
+
+/**
+ * Attack generation for every piece type. The single-square functions
+ * read the precomputed tables of the geometry; the set-wise step, slide
+ * and king work on whole square sets for the evaluation's pawn structure
+ * and king zone and for the x-rays of checkInfo.
+ */
+namespace Student
+{
+    namespace attacks
+    {
+        /**
+         * @brief
+         * Moves every square of a set one step in a direction.
+         * Squares that would leave the board are dropped.
+         */
+        template <class Geo>
+        inline typename Geo::Bitboard step(const Geo &geo, typename Geo::Bitboard b, Direction dir)
+        {
+            return bits::shift(b, geo.delta(dir)) & geo.landing(dir);
+        }
+
+        /**
+         * @brief
+         * Kogge-Stone occluded fill.
+         * @param from
+         * The sliding pieces.
+         * @param dir
+         * The direction of the ray.
+         * @param empty
+         * The empty squares of the board.
+         * @return
+         * Every square reached in the direction up to and including the
+         * first occupied square.
+         */
+        template <class Geo>
+        inline typename Geo::Bitboard slide(const Geo &geo, typename Geo::Bitboard from, Direction dir, typename Geo::Bitboard empty)
+        {
+            typename Geo::Bitboard pro = empty & geo.landing(dir);
+            int shiftBy = geo.delta(dir);
+            for (int pass = 0; pass < geo.fillSteps(); pass++)
+            {
+                from |= pro & bits::shift(from, shiftBy);
+                pro &= bits::shift(pro, shiftBy);
+                shiftBy *= 2;
+            }
+            return step(geo, from, dir);
+        }
+
+        /**
+         * @return
+         * The squares reached from one square in a direction, up to and
+         * including the first occupied square, from the ray table.
+         */
+        template <class Geo>
+        inline typename Geo::Bitboard ray(const Geo &geo, int square, Direction dir, typename Geo::Bitboard occupied)
+        {
+            const auto &rays = geo.rays();
+            typename Geo::Bitboard reached = rays.ray[dir][square];
+            typename Geo::Bitboard blockers = reached & occupied;
+            if (bits::any(blockers))
+            {
+                int blocker = geometry::towardsHigherSquares(dir) ? bits::lsb(blockers) : bits::msb(blockers);
+                reached ^= rays.ray[dir][blocker];
+            }
+            return reached;
+        }
+
+        /**
+         * @return
+         * The squares strictly between two squares sharing a row, column or
+         * diagonal, or no squares if they share none.
+         */
+        template <class Geo>
+        inline typename Geo::Bitboard between(const Geo &geo, int from, int to)
+        {
+            const auto &rays = geo.rays();
+            Direction dir = geo.directionTowards(from, to);
+            if (!bits::test(rays.ray[dir][from], to))
+                return typename Geo::Bitboard{};
+            return rays.ray[dir][from] & rays.ray[geometry::reverse(dir)][to];
+        }
+
+        /**
+         * @brief
+         * Attacks of a rook on one square: a magic table lookup on the
+         * standard board, four ray lookups on the others.
+         */
+        template <class Geo>
+        inline typename Geo::Bitboard rookFrom(const Geo &geo, int square, typename Geo::Bitboard occupied)
+        {
+            if constexpr (std::is_same<Geo, StaticGeometry<8, 8>>::value)
+                return magic::rook(square, occupied);
+            else
+                return ray(geo, square, North, occupied) | ray(geo, square, South, occupied) |
+                       ray(geo, square, East, occupied) | ray(geo, square, West, occupied);
+        }
+
+        /**
+         * @brief
+         * Attacks of a bishop on one square, looked up like rookFrom.
+         */
+        template <class Geo>
+        inline typename Geo::Bitboard bishopFrom(const Geo &geo, int square, typename Geo::Bitboard occupied)
+        {
+            if constexpr (std::is_same<Geo, StaticGeometry<8, 8>>::value)
+                return magic::bishop(square, occupied);
+            else
+                return ray(geo, square, NorthEast, occupied) | ray(geo, square, NorthWest, occupied) |
+                       ray(geo, square, SouthEast, occupied) | ray(geo, square, SouthWest, occupied);
+        }
+
+        /**
+         * @return
+         * The squares around a king on one square, from the step table.
+         */
+        template <class Geo>
+        inline typename Geo::Bitboard kingFrom(const Geo &geo, int square)
+        {
+            return geo.steps().king[square];
+        }
+
+        /**
+         * @return
+         * The diagonal capture squares of a pawn on one square, from the
+         * step table.
+         */
+        template <class Geo>
+        inline typename Geo::Bitboard pawnFrom(const Geo &geo, Color color, int square)
+        {
+            return geo.steps().pawnCapture[color][square];
+        }
+
+        template <class Geo>
+        inline typename Geo::Bitboard king(const Geo &geo, typename Geo::Bitboard from)
+        {
+            typename Geo::Bitboard sideways = step(geo, from, East) | step(geo, from, West);
+            typename Geo::Bitboard row = from | sideways;
+            return sideways | step(geo, row, North) | step(geo, row, South);
+        }
+
+        /**
+         * @return
+         * Direction in which a pawn of the given colour advances.
+         */
+        inline Direction pawnPush(Color color)
+        {
+            return color == Black ? South : North;
+        }
+    }
+}
+
+#endif
@@ -9,7 +9,7 @@
  */
 namespace Student
 {
-    class BishopPiece : public ChessPiece
+    class BishopPiece final : public ChessPiece
     {
     public:
         BishopPiece(ChessBoard &board, Color color, int row, int column, Type type);
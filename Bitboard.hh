@@ -0,0 +1,242 @@
+#ifndef __BITBOARD_H__
+#define __BITBOARD_H__
+
+#include <cstdint>
+
+/**
+ * Square sets used by the position backend.
+ * A square (row, column) is stored at bit index row * numCols + column.
+ */
+namespace Student
+{
+    /**
+     * @brief
+     * Square set for boards of at most 64 squares.
+     */
+    using Bitboard = std::uint64_t;
+
+    /**
+     * @brief
+     * Square set for boards larger than 64 squares.
+     * Behaves like a (64 * Words)-bit unsigned integer: bit 0 is the lowest
+     * bit of word[0], and shifts carry across word boundaries.
+     */
+    template <int Words>
+    struct WideBitboardN
+    {
+        std::uint64_t word[Words];
+
+        constexpr WideBitboardN &operator&=(const WideBitboardN &other)
+        {
+            for (int i = 0; i < Words; i++)
+                word[i] &= other.word[i];
+            return *this;
+        }
+
+        constexpr WideBitboardN &operator|=(const WideBitboardN &other)
+        {
+            for (int i = 0; i < Words; i++)
+                word[i] |= other.word[i];
+            return *this;
+        }
+
+        constexpr WideBitboardN &operator^=(const WideBitboardN &other)
+        {
+            for (int i = 0; i < Words; i++)
+                word[i] ^= other.word[i];
+            return *this;
+        }
+
+        friend constexpr WideBitboardN operator&(WideBitboardN a, const WideBitboardN &b) { return a &= b; }
+        friend constexpr WideBitboardN operator|(WideBitboardN a, const WideBitboardN &b) { return a |= b; }
+        friend constexpr WideBitboardN operator^(WideBitboardN a, const WideBitboardN &b) { return a ^= b; }
+
+        friend constexpr WideBitboardN operator~(WideBitboardN a)
+        {
+            for (int i = 0; i < Words; i++)
+                a.word[i] = ~a.word[i];
+            return a;
+        }
+
+        friend constexpr bool operator==(const WideBitboardN &a, const WideBitboardN &b)
+        {
+            for (int i = 0; i < Words; i++)
+                if (a.word[i] != b.word[i])
+                    return false;
+            return true;
+        }
+
+        friend constexpr bool operator!=(const WideBitboardN &a, const WideBitboardN &b) { return !(a == b); }
+
+        friend constexpr WideBitboardN operator<<(const WideBitboardN &a, int n)
+        {
+            WideBitboardN r{};
+            int wordShift = n / 64;
+            int bitShift = n % 64;
+            for (int i = Words - 1; i >= wordShift; i--)
+            {
+                r.word[i] = a.word[i - wordShift] << bitShift;
+                if (bitShift != 0 && i - wordShift - 1 >= 0)
+                    r.word[i] |= a.word[i - wordShift - 1] >> (64 - bitShift);
+            }
+            return r;
+        }
+
+        friend constexpr WideBitboardN operator>>(const WideBitboardN &a, int n)
+        {
+            WideBitboardN r{};
+            int wordShift = n / 64;
+            int bitShift = n % 64;
+            for (int i = 0; i + wordShift < Words; i++)
+            {
+                r.word[i] = a.word[i + wordShift] >> bitShift;
+                if (bitShift != 0 && i + wordShift + 1 < Words)
+                    r.word[i] |= a.word[i + wordShift + 1] << (64 - bitShift);
+            }
+            return r;
+        }
+    };
+
+    /**
+     * @brief
+     * Square set for boards of up to 256 squares (16x16).
+     */
+    using WideBitboard = WideBitboardN<4>;
+
+    /**
+     * @brief
+     * Compile-time properties of a square set type.
+     */
+    template <class BB>
+    struct BitboardTraits;
+
+    template <>
+    struct BitboardTraits<Bitboard>
+    {
+        static constexpr int capacity = 64;
+    };
+
+    template <int Words>
+    struct BitboardTraits<WideBitboardN<Words>>
+    {
+        static constexpr int capacity = 64 * Words;
+    };
+
+    namespace bits
+    {
+        template <class BB>
+        constexpr BB squareMask(int square);
+
+        template <>
+        constexpr Bitboard squareMask<Bitboard>(int square)
+        {
+            return Bitboard(1) << square;
+        }
+
+        inline bool any(Bitboard b) { return b != 0; }
+        inline bool test(Bitboard b, int square) { return (b >> square) & 1; }
+        inline int popCount(Bitboard b) { return __builtin_popcountll(b); }
+        inline int lsb(Bitboard b) { return __builtin_ctzll(b); }
+        inline int msb(Bitboard b) { return 63 - __builtin_clzll(b); }
+
+        /**
+         * @brief
+         * Shifts towards higher square indices for positive n and towards
+         * lower ones for negative n. Bits shifted past either end are dropped.
+         */
+        inline Bitboard shift(Bitboard b, int n)
+        {
+            if (n >= 64 || n <= -64)
+                return 0;
+            return n >= 0 ? b << n : b >> -n;
+        }
+
+        template <class BB>
+        constexpr BB squareMask(int square)
+        {
+            BB b{};
+            b.word[square / 64] = std::uint64_t(1) << (square % 64);
+            return b;
+        }
+
+        template <int Words>
+        inline bool any(const WideBitboardN<Words> &b)
+        {
+            std::uint64_t acc = 0;
+            for (int i = 0; i < Words; i++)
+                acc |= b.word[i];
+            return acc != 0;
+        }
+
+        template <int Words>
+        inline bool test(const WideBitboardN<Words> &b, int square)
+        {
+            return (b.word[square / 64] >> (square % 64)) & 1;
+        }
+
+        template <int Words>
+        inline int popCount(const WideBitboardN<Words> &b)
+        {
+            int count = 0;
+            for (int i = 0; i < Words; i++)
+                count += __builtin_popcountll(b.word[i]);
+            return count;
+        }
+
+        /**
+         * @brief
+         * Index of the lowest set bit. The set must not be empty.
+         */
+        template <int Words>
+        inline int lsb(const WideBitboardN<Words> &b)
+        {
+            int i = 0;
+            while (b.word[i] == 0)
+                i++;
+            return i * 64 + __builtin_ctzll(b.word[i]);
+        }
+
+        /**
+         * @brief
+         * Index of the highest set bit. The set must not be empty.
+         */
+        template <int Words>
+        inline int msb(const WideBitboardN<Words> &b)
+        {
+            int i = Words - 1;
+            while (b.word[i] == 0)
+                i--;
+            return i * 64 + 63 - __builtin_clzll(b.word[i]);
+        }
+
+        template <int Words>
+        inline WideBitboardN<Words> shift(const WideBitboardN<Words> &b, int n)
+        {
+            if (n >= 64 * Words || n <= -64 * Words)
+                return WideBitboardN<Words>{};
+            return n >= 0 ? b << n : b >> -n;
+        }
+
+        /**
+         * @brief
+         * Removes the lowest set bit and returns its index.
+         * The set must not be empty.
+         */
+        template <class BB>
+        inline int popLsb(BB &b)
+        {
+            int square = lsb(b);
+            b ^= squareMask<BB>(square);
+            return square;
+        }
+
+        inline int popLsb(Bitboard &b)
+        {
+            int square = lsb(b);
+            b &= b - 1;
+            return square;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,534 @@
+#ifndef __BOARDGEOMETRY_H__
+#define __BOARDGEOMETRY_H__
+
+#include "Chess.h"
+#include "Bitboard.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace Student
+{
+    /**
+     * The eight ray directions on the board.
+     * North is towards row 0, East is towards the last column.
+     */
+    enum Direction
+    {
+        North,
+        South,
+        East,
+        West,
+        NorthEast,
+        NorthWest,
+        SouthEast,
+        SouthWest,
+    };
+
+    /**
+     * @return
+     * The colour playing against the given one.
+     */
+    inline Color opponent(Color color)
+    {
+        return color == White ? Black : White;
+    }
+
+    constexpr int directionCount = 8;
+
+    /**
+     * @brief
+     * The squares each direction reaches from each square on an empty
+     * board. Slider attacks and the squares between two aligned squares
+     * are looked up here instead of being walked square by square.
+     */
+    template <class BB>
+    struct RayTable
+    {
+        BB ray[directionCount][BitboardTraits<BB>::capacity];
+    };
+
+    /**
+     * @brief
+     * The squares a king or a pawn may step to from each square, the rows
+     * pawns start on and the castling rook corners of a board size.
+     * Indexed by Color where the rule depends on it: Black pawns advance
+     * towards higher rows and White pawns towards lower rows.
+     */
+    template <class BB>
+    struct StepTable
+    {
+        BB king[BitboardTraits<BB>::capacity];
+        BB pawnPush[2][BitboardTraits<BB>::capacity];
+        /** The two-square advance, from the start row only. */
+        BB pawnDoublePush[2][BitboardTraits<BB>::capacity];
+        BB pawnCapture[2][BitboardTraits<BB>::capacity];
+        BB pawnStart[2];
+        /** Corner rook of a king castling from the square: [0] towards column 0, [1] towards the last column. */
+        std::int16_t castlingRook[BitboardTraits<BB>::capacity][2];
+    };
+
+    namespace geometry
+    {
+        constexpr int rowStep(Direction dir)
+        {
+            return (dir == North || dir == NorthEast || dir == NorthWest) ? -1 : (dir == South || dir == SouthEast || dir == SouthWest) ? 1 : 0;
+        }
+
+        constexpr int columnStep(Direction dir)
+        {
+            return (dir == East || dir == NorthEast || dir == SouthEast) ? 1 : (dir == West || dir == NorthWest || dir == SouthWest) ? -1 : 0;
+        }
+
+        /**
+         * @return
+         * The direction pointing the other way.
+         */
+        constexpr Direction reverse(Direction dir)
+        {
+            switch (dir)
+            {
+            case North:
+                return South;
+            case South:
+                return North;
+            case East:
+                return West;
+            case West:
+                return East;
+            case NorthEast:
+                return SouthWest;
+            case NorthWest:
+                return SouthEast;
+            case SouthEast:
+                return NorthWest;
+            default:
+                return NorthEast;
+            }
+        }
+
+        /**
+         * @return
+         * True if the square index grows along the direction, so the
+         * nearest square of a ray is its lowest one.
+         */
+        constexpr bool towardsHigherSquares(Direction dir)
+        {
+            return dir == South || dir == East || dir == SouthEast || dir == SouthWest;
+        }
+
+        template <class BB>
+        constexpr void buildTable(RayTable<BB> &table, int numRows, int numCols)
+        {
+            for (int dir = 0; dir < directionCount; dir++)
+            {
+                for (int sq = 0; sq < numRows * numCols; sq++)
+                {
+                    BB ray{};
+                    int row = sq / numCols + rowStep(Direction(dir));
+                    int column = sq % numCols + columnStep(Direction(dir));
+                    while (row >= 0 && row < numRows && column >= 0 && column < numCols)
+                    {
+                        ray |= bits::squareMask<BB>(row * numCols + column);
+                        row += rowStep(Direction(dir));
+                        column += columnStep(Direction(dir));
+                    }
+                    table.ray[dir][sq] = ray;
+                }
+            }
+        }
+
+        template <class BB>
+        constexpr void buildTable(StepTable<BB> &table, int numRows, int numCols)
+        {
+            for (int sq = 0; sq < numRows * numCols; sq++)
+            {
+                int row = sq / numCols;
+                int column = sq % numCols;
+                BB king{};
+                for (int dir = 0; dir < directionCount; dir++)
+                {
+                    int toRow = row + rowStep(Direction(dir));
+                    int toColumn = column + columnStep(Direction(dir));
+                    if (toRow >= 0 && toRow < numRows && toColumn >= 0 && toColumn < numCols)
+                        king |= bits::squareMask<BB>(toRow * numCols + toColumn);
+                }
+                table.king[sq] = king;
+
+                for (int color = Black; color <= White; color++)
+                {
+                    int forward = (color == Black) ? 1 : -1;
+                    int startRow = (color == Black) ? 1 : numRows - 2;
+                    int toRow = row + forward;
+                    BB push{};
+                    BB doublePush{};
+                    BB capture{};
+                    if (toRow >= 0 && toRow < numRows)
+                    {
+                        push = bits::squareMask<BB>(toRow * numCols + column);
+                        if (column > 0)
+                            capture |= bits::squareMask<BB>(toRow * numCols + column - 1);
+                        if (column + 1 < numCols)
+                            capture |= bits::squareMask<BB>(toRow * numCols + column + 1);
+                        if (row == startRow && toRow + forward >= 0 && toRow + forward < numRows)
+                            doublePush = bits::squareMask<BB>((toRow + forward) * numCols + column);
+                    }
+                    if (row == startRow)
+                        table.pawnStart[color] |= bits::squareMask<BB>(sq);
+                    table.pawnPush[color][sq] = push;
+                    table.pawnDoublePush[color][sq] = doublePush;
+                    table.pawnCapture[color][sq] = capture;
+                }
+
+                table.castlingRook[sq][0] = std::int16_t(row * numCols);
+                table.castlingRook[sq][1] = std::int16_t(row * numCols + numCols - 1);
+            }
+        }
+
+        template <class Table>
+        constexpr Table makeTable(int numRows, int numCols)
+        {
+            Table table{};
+            buildTable(table, numRows, numCols);
+            return table;
+        }
+
+        /**
+         * @return
+         * Position of a numRows x numCols board among all board sizes of
+         * at most maxSquares squares, ordered by rows, then columns, so
+         * per-size caches can be flat arrays.
+         */
+        constexpr int sizeIndex(int numRows, int numCols, int maxSquares)
+        {
+            int index = 0;
+            for (int row = 1; row < numRows; row++)
+                index += maxSquares / row;
+            return index + numCols - 1;
+        }
+
+        /**
+         * @return
+         * Number of board sizes of at most maxSquares squares.
+         */
+        constexpr int sizeCount(int maxSquares)
+        {
+            return sizeIndex(maxSquares + 1, 1, maxSquares);
+        }
+
+        /**
+         * @return
+         * The table of a numRows x numCols board, filled by build on first
+         * use and shared by every later caller for that size; tables are
+         * never freed. Once built, a lookup is one atomic load. Safe to
+         * call from any thread: threads racing on a new size may each
+         * build a table, and all but the first to publish discard theirs.
+         */
+        template <class Table, int MaxSquares>
+        const Table &cachedTable(int numRows, int numCols, void (*build)(Table &, int, int))
+        {
+            // Zero-initialised before any dynamic initialisation, so usable from static initialisers
+            static std::atomic<const Table *> tables[sizeCount(MaxSquares)];
+            std::atomic<const Table *> &slot = tables[sizeIndex(numRows, numCols, MaxSquares)];
+            const Table *table = slot.load(std::memory_order_acquire);
+            if (table != nullptr)
+                return *table;
+
+            std::unique_ptr<Table> built(new Table());
+            build(*built, numRows, numCols);
+            if (slot.compare_exchange_strong(table, built.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+                return *built.release();
+            return *table;
+        }
+    }
+
+    /**
+     * @brief
+     * Dimensions of a board and the edge masks needed to shift square
+     * sets without wrapping from one row into the next.
+     * BB is the square set type and must hold numRows * numCols bits.
+     */
+    template <class BB>
+    class BoardGeometry
+    {
+    public:
+        using Bitboard = BB;
+        static constexpr int maxSquares = BitboardTraits<BB>::capacity;
+
+        /**
+         * @param numRow
+         * Number of rows of the board.
+         * @param numCol
+         * Number of columns of the board.
+         */
+        BoardGeometry(int numRow, int numCol)
+            : numRows(numRow), numCols(numCol),
+              rayTable(&geometry::cachedTable<RayTable<BB>, maxSquares>(numRow, numCol, geometry::buildTable)),
+              stepTable(&geometry::cachedTable<StepTable<BB>, maxSquares>(numRow, numCol, geometry::buildTable))
+        {
+            int longest = numRows > numCols ? numRows : numCols;
+            while ((1 << fillPasses) < longest)
+            {
+                fillPasses++;
+            }
+            for (int sq = 0; sq < numRows * numCols; sq++)
+            {
+                allSquares |= bits::squareMask<BB>(sq);
+                if (sq % numCols != 0)
+                    notFirstColumn |= bits::squareMask<BB>(sq);
+                if (sq % numCols != numCols - 1)
+                    notLastColumn |= bits::squareMask<BB>(sq);
+            }
+        }
+
+        int rows() const { return numRows; }
+        int cols() const { return numCols; }
+        int squares() const { return numRows * numCols; }
+
+        int square(int row, int column) const { return row * numCols + column; }
+        int rowOf(int square) const { return square / numCols; }
+        int columnOf(int square) const { return square % numCols; }
+
+        bool contains(int row, int column) const
+        {
+            return row >= 0 && row < numRows && column >= 0 && column < numCols;
+        }
+
+        /**
+         * @return
+         * The set of all squares on the board.
+         */
+        BB all() const { return allSquares; }
+
+        /**
+         * @return
+         * Square index offset of one step in the given direction.
+         */
+        int delta(Direction dir) const
+        {
+            switch (dir)
+            {
+            case North:
+                return -numCols;
+            case South:
+                return numCols;
+            case East:
+                return 1;
+            case West:
+                return -1;
+            case NorthEast:
+                return 1 - numCols;
+            case NorthWest:
+                return -1 - numCols;
+            case SouthEast:
+                return numCols + 1;
+            default:
+                return numCols - 1;
+            }
+        }
+
+        /**
+         * @return
+         * The direction leading from one square towards another that shares
+         * its row, column or diagonal.
+         */
+        Direction directionTowards(int from, int to) const
+        {
+            static const Direction directions[3][3] = {
+                {NorthWest, North, NorthEast},
+                {West, North, East},
+                {SouthWest, South, SouthEast},
+            };
+            int rowStep = (rowOf(to) > rowOf(from)) - (rowOf(to) < rowOf(from));
+            int columnStep = (columnOf(to) > columnOf(from)) - (columnOf(to) < columnOf(from));
+            return directions[rowStep + 1][columnStep + 1];
+        }
+
+        /**
+         * @return
+         * The squares a one-step shift in the given direction may land on.
+         * Eastward shifts can never land on the first column and westward
+         * shifts never on the last one.
+         */
+        BB landing(Direction dir) const
+        {
+            switch (dir)
+            {
+            case East:
+            case NorthEast:
+            case SouthEast:
+                return notFirstColumn;
+            case West:
+            case NorthWest:
+            case SouthWest:
+                return notLastColumn;
+            default:
+                return allSquares;
+            }
+        }
+
+        /**
+         * @return
+         * Number of doubling passes an occluded fill needs to cross the
+         * longest side of the board.
+         */
+        int fillSteps() const { return fillPasses; }
+
+        /**
+         * @return
+         * The ray table of this board size.
+         */
+        const RayTable<BB> &rays() const { return *rayTable; }
+
+        /**
+         * @return
+         * The king and pawn step table of this board size.
+         */
+        const StepTable<BB> &steps() const { return *stepTable; }
+
+    private:
+        int numRows = 0;
+        int numCols = 0;
+        int fillPasses = 0;
+        const RayTable<BB> *rayTable = nullptr;
+        const StepTable<BB> *stepTable = nullptr;
+        BB allSquares{};
+        BB notFirstColumn{};
+        BB notLastColumn{};
+    };
+
+    namespace geometry
+    {
+        /**
+         * @return
+         * The squares of a numRows x numCols board, except those in the
+         * given column (none if skipColumn is negative).
+         */
+        template <class BB>
+        constexpr BB squaresOutsideColumn(int numRows, int numCols, int skipColumn)
+        {
+            BB b{};
+            for (int sq = 0; sq < numRows * numCols; sq++)
+            {
+                if (sq % numCols != skipColumn)
+                    b |= bits::squareMask<BB>(sq);
+            }
+            return b;
+        }
+
+        /**
+         * @return
+         * Number of doubling passes needed to cross a side of the given length.
+         */
+        constexpr int fillPassesFor(int longest)
+        {
+            int passes = 0;
+            while ((1 << passes) < longest)
+                passes++;
+            return passes;
+        }
+    }
+
+    /**
+     * @brief
+     * BoardGeometry with the dimensions fixed at compile time. It has the
+     * same interface, but every query is a constant expression, so square
+     * arithmetic folds and fill loops have constant trip counts the
+     * compiler can unroll. Boards of up to 64 squares use Bitboard.
+     */
+    template <int Rows, int Cols>
+    class StaticGeometry
+    {
+        static_assert(Rows > 0 && Cols > 0 && Rows * Cols <= BitboardTraits<WideBitboard>::capacity,
+                      "a board holds at most 256 squares");
+
+    public:
+        using Bitboard = std::conditional_t<(Rows * Cols <= 64), Student::Bitboard, WideBitboard>;
+        static constexpr int maxSquares = BitboardTraits<Bitboard>::capacity;
+
+        static constexpr int rows() { return Rows; }
+        static constexpr int cols() { return Cols; }
+        static constexpr int squares() { return Rows * Cols; }
+
+        static constexpr int square(int row, int column) { return row * Cols + column; }
+        static constexpr int rowOf(int square) { return square / Cols; }
+        static constexpr int columnOf(int square) { return square % Cols; }
+
+        static constexpr bool contains(int row, int column)
+        {
+            return row >= 0 && row < Rows && column >= 0 && column < Cols;
+        }
+
+        static constexpr Bitboard all() { return allSquares; }
+
+        static constexpr int delta(Direction dir)
+        {
+            switch (dir)
+            {
+            case North:
+                return -Cols;
+            case South:
+                return Cols;
+            case East:
+                return 1;
+            case West:
+                return -1;
+            case NorthEast:
+                return 1 - Cols;
+            case NorthWest:
+                return -1 - Cols;
+            case SouthEast:
+                return Cols + 1;
+            default:
+                return Cols - 1;
+            }
+        }
+
+        static Direction directionTowards(int from, int to)
+        {
+            static const Direction directions[3][3] = {
+                {NorthWest, North, NorthEast},
+                {West, North, East},
+                {SouthWest, South, SouthEast},
+            };
+            int rowStep = (rowOf(to) > rowOf(from)) - (rowOf(to) < rowOf(from));
+            int columnStep = (columnOf(to) > columnOf(from)) - (columnOf(to) < columnOf(from));
+            return directions[rowStep + 1][columnStep + 1];
+        }
+
+        static constexpr Bitboard landing(Direction dir)
+        {
+            switch (dir)
+            {
+            case East:
+            case NorthEast:
+            case SouthEast:
+                return notFirstColumn;
+            case West:
+            case NorthWest:
+            case SouthWest:
+                return notLastColumn;
+            default:
+                return allSquares;
+            }
+        }
+
+        static constexpr int fillSteps() { return fillPasses; }
+
+        static constexpr const RayTable<Bitboard> &rays() { return rayTable; }
+        static constexpr const StepTable<Bitboard> &steps() { return stepTable; }
+
+    private:
+        static constexpr RayTable<Bitboard> rayTable = geometry::makeTable<RayTable<Bitboard>>(Rows, Cols);
+        static constexpr StepTable<Bitboard> stepTable = geometry::makeTable<StepTable<Bitboard>>(Rows, Cols);
+        static constexpr int fillPasses = geometry::fillPassesFor(Rows > Cols ? Rows : Cols);
+        static constexpr Bitboard allSquares = geometry::squaresOutsideColumn<Bitboard>(Rows, Cols, -1);
+        static constexpr Bitboard notFirstColumn = geometry::squaresOutsideColumn<Bitboard>(Rows, Cols, 0);
+        static constexpr Bitboard notLastColumn = geometry::squaresOutsideColumn<Bitboard>(Rows, Cols, Cols - 1);
+    };
+}
+
+#endif
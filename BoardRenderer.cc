@@ -0,0 +1,176 @@
+#include "BoardRenderer.hh"
+#include "PositionCodec.hh"
+
+#include <cstring>
+
+namespace Student
+{
+    namespace
+    {
+        struct Glyph
+        {
+            char bytes[3];
+            std::uint8_t length;
+        };
+
+        /** Glyph of each piece code for the displayBoard layouts, indexed by code. */
+        const Glyph unicodeGlyphs[] = {
+            {{' '}, 1},
+            {{'\xE2', '\x99', '\x9F'}, 3}, // ♟
+            {{'\xE2', '\x99', '\x9C'}, 3}, // ♜
+            {{'\xE2', '\x99', '\x9D'}, 3}, // ♝
+            {{'\xE2', '\x99', '\x9A'}, 3}, // ♚
+            {{'\xE2', '\x99', '\x99'}, 3}, // ♙
+            {{'\xE2', '\x99', '\x96'}, 3}, // ♖
+            {{'\xE2', '\x99', '\x97'}, 3}, // ♗
+            {{'\xE2', '\x99', '\x94'}, 3}, // ♔
+        };
+
+        int digitCount(int value)
+        {
+            return value >= 100 ? 3 : value >= 10 ? 2 : 1;
+        }
+
+        char *writeNumber(int value, char *out)
+        {
+            if (value >= 100)
+                *out++ = char('0' + value / 100);
+            if (value >= 10)
+                *out++ = char('0' + value / 10 % 10);
+            *out++ = char('0' + value % 10);
+            return out;
+        }
+
+        char *writeBorder(int numCols, char *out)
+        {
+            *out++ = ' ';
+            *out++ = ' ';
+            std::memset(out, '-', std::size_t(numCols));
+            out += numCols;
+            *out++ = '\n';
+            return out;
+        }
+
+        /** Length of a rendering without the terminating null. */
+        std::size_t renderLength(int numRows, int numCols, RenderFormat format)
+        {
+            if (format == RenderFen)
+            {
+                return fenBound(numRows, numCols) + 1;
+            }
+            std::size_t glyphBytes = (format == RenderUnicode) ? 3 : 1;
+            std::size_t length = 0;
+            // Column scale, top border, bottom border and blank line
+            length += 2 + 1;
+            for (int column = 0; column < numCols; column++)
+            {
+                length += std::size_t(digitCount(column));
+            }
+            length += 2 * (2 + std::size_t(numCols) + 1) + 1;
+            for (int row = 0; row < numRows; row++)
+            {
+                length += std::size_t(digitCount(row)) + 1 + std::size_t(numCols) * glyphBytes + 2;
+            }
+            return length;
+        }
+
+        template <class Position>
+        char *renderPosition(const Position &pos, RenderFormat format, char *out)
+        {
+            if (format == RenderFen)
+            {
+                out = writeFen(pos, out);
+                *out++ = '\n';
+                return out;
+            }
+
+            int numRows = pos.geometry().rows();
+            int numCols = pos.geometry().cols();
+            *out++ = ' ';
+            *out++ = ' ';
+            for (int column = 0; column < numCols; column++)
+            {
+                out = writeNumber(column, out);
+            }
+            *out++ = '\n';
+            out = writeBorder(numCols, out);
+
+            for (int row = 0; row < numRows; row++)
+            {
+                out = writeNumber(row, out);
+                *out++ = '|';
+                for (int column = 0; column < numCols; column++)
+                {
+                    std::uint8_t code = pos.codeAt(row * numCols + column);
+                    if (format == RenderAscii)
+                    {
+                        *out++ = codec::pieceLetters[code];
+                        continue;
+                    }
+                    const Glyph &glyph = unicodeGlyphs[code];
+                    std::memcpy(out, glyph.bytes, glyph.length);
+                    out += glyph.length;
+                }
+                *out++ = '|';
+                *out++ = '\n';
+            }
+
+            out = writeBorder(numCols, out);
+            *out++ = '\n';
+            return out;
+        }
+
+        /**
+         * @brief
+         * Renders count boards back to back; boardAt(i) returns the i-th
+         * ChessBoard or BoardSnapshot.
+         */
+        template <class BoardAt>
+        std::size_t renderMany(std::size_t count, BoardAt boardAt, RenderFormat format, char *buffer, std::size_t capacity)
+        {
+            std::size_t needed = 1;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                needed += renderLength(boardAt(i).getNumRows(), boardAt(i).getNumCols(), format);
+            }
+            if (capacity < needed)
+            {
+                return 0;
+            }
+            char *out = buffer;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                out = boardAt(i).withPosition([&](const auto &pos) { return renderPosition(pos, format, out); });
+            }
+            *out = '\0';
+            return std::size_t(out - buffer);
+        }
+    }
+
+    std::size_t renderBound(int numRows, int numCols, RenderFormat format)
+    {
+        return renderLength(numRows, numCols, format) + 1;
+    }
+
+    std::size_t renderBoard(const ChessBoard &board, RenderFormat format, char *buffer, std::size_t capacity)
+    {
+        return renderMany(1, [&](std::size_t) -> const ChessBoard & { return board; }, format, buffer, capacity);
+    }
+
+    std::size_t renderBoard(const BoardSnapshot &snapshot, RenderFormat format, char *buffer, std::size_t capacity)
+    {
+        return renderMany(1, [&](std::size_t) -> const BoardSnapshot & { return snapshot; }, format, buffer, capacity);
+    }
+
+    std::size_t renderBoards(const ChessBoard *const *boards, std::size_t count, RenderFormat format,
+                             char *buffer, std::size_t capacity)
+    {
+        return renderMany(count, [&](std::size_t i) -> const ChessBoard & { return *boards[i]; }, format, buffer, capacity);
+    }
+
+    std::size_t renderBoards(const BoardSnapshot *snapshots, std::size_t count, RenderFormat format,
+                             char *buffer, std::size_t capacity)
+    {
+        return renderMany(count, [&](std::size_t i) -> const BoardSnapshot & { return snapshots[i]; }, format, buffer, capacity);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef __BOARDRENDERER_H__
+#define __BOARDRENDERER_H__
+
+#include "ChessBoard.hh"
+
+#include <cstddef>
+
+namespace Student
+{
+    /**
+     * @brief
+     * Text layouts a board can be rendered in.
+     */
+    enum RenderFormat
+    {
+        /** The layout of displayBoard, with Unicode chess glyphs. */
+        RenderUnicode,
+        /** The layout of displayBoard, with the FEN piece letters. */
+        RenderAscii,
+        /** One FEN-style line, as toFen writes it, ending in a newline. */
+        RenderFen,
+    };
+
+    /**
+     * @return
+     * The buffer size renderBoard needs for a board of these dimensions,
+     * terminating null included. Every board of the size fits.
+     */
+    std::size_t renderBound(int numRows, int numCols, RenderFormat format);
+
+    /**
+     * @brief
+     * Renders a board into a caller-supplied buffer, without allocating.
+     * Glyphs and labels come from lookup tables, and the pieces are read
+     * from the bitboard position rather than through the piece objects.
+     * @param capacity
+     * Size of the buffer; at least renderBound for the board.
+     * @return
+     * Number of characters written, not counting the terminating null
+     * written after them, or 0 if the buffer is too small.
+     */
+    std::size_t renderBoard(const ChessBoard &board, RenderFormat format, char *buffer, std::size_t capacity);
+    std::size_t renderBoard(const BoardSnapshot &snapshot, RenderFormat format, char *buffer, std::size_t capacity);
+
+    /**
+     * @brief
+     * Renders many boards back to back into one buffer, with a single
+     * terminating null at the end.
+     * @return
+     * Number of characters written, or 0 if the buffer cannot hold the
+     * sum of the boards' render bounds.
+     */
+    std::size_t renderBoards(const ChessBoard *const *boards, std::size_t count, RenderFormat format,
+                             char *buffer, std::size_t capacity);
+    std::size_t renderBoards(const BoardSnapshot *snapshots, std::size_t count, RenderFormat format,
+                             char *buffer, std::size_t capacity);
+}
+
+#endif
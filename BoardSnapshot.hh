@@ -0,0 +1,125 @@
+#ifndef __BOARDSNAPSHOT_H__
+#define __BOARDSNAPSHOT_H__
+
+#include "Position.hh"
+#include "PositionQueries.hh"
+
+#include <memory>
+#include <utility>
+#include <variant>
+
+namespace Student
+{
+    /**
+     * @brief
+     * The bitboard position behind a ChessBoard, whichever size it is.
+     */
+    using PositionVariant = std::variant<StandardPosition, NarrowPosition, WidePosition>;
+
+    /**
+     * @brief
+     * Immutable-by-default copy of a board's position: the pieces, their
+     * moved flags, the castling rights and the side to move, without any
+     * piece objects. Taking one copies the bitboard position, a few cache
+     * lines; copying a snapshot only shares it, so read-mostly analysis
+     * branches can pass snapshots around freely. The first call to
+     * modifyPosition on a shared snapshot gives it a private copy of the
+     * position (copy-on-write).
+     *
+     * Copies of one snapshot may be read from several threads. A snapshot
+     * itself must not be modified while another thread uses the same object.
+     */
+    class BoardSnapshot
+    {
+    public:
+        explicit BoardSnapshot(const PositionVariant &position)
+            : position(std::make_shared<PositionVariant>(position))
+        {
+        }
+
+        /**
+         * @brief
+         * Calls visitor with a const reference to the position.
+         */
+        template <class Visitor>
+        decltype(auto) withPosition(Visitor &&visitor) const
+        {
+            const PositionVariant &shared = *position;
+            return std::visit(std::forward<Visitor>(visitor), shared);
+        }
+
+        /**
+         * @brief
+         * Calls visitor with a mutable reference to the position, first
+         * copying it if other snapshots share it.
+         */
+        template <class Visitor>
+        decltype(auto) modifyPosition(Visitor &&visitor)
+        {
+            if (position.use_count() > 1)
+            {
+                position = std::make_shared<PositionVariant>(*position);
+            }
+            return std::visit(std::forward<Visitor>(visitor), *position);
+        }
+
+        const PositionVariant &getPosition() const { return *position; }
+
+        int getNumRows() const
+        {
+            return withPosition([](const auto &pos) { return pos.geometry().rows(); });
+        }
+        int getNumCols() const
+        {
+            return withPosition([](const auto &pos) { return pos.geometry().cols(); });
+        }
+        Color getTurn() const
+        {
+            return withPosition([](const auto &pos) { return pos.sideToMove(); });
+        }
+        std::uint64_t getHash() const
+        {
+            return withPosition([](const auto &pos) { return pos.hash(); });
+        }
+
+        /**
+         * @brief
+         * The read-only queries of ChessBoard, answered from the snapshot.
+         */
+        bool isValidMove(int fromRow, int fromColumn, int toRow, int toColumn) const
+        {
+            return withPosition([&](const auto &pos) {
+                return queries::isValidMove(pos, fromRow, fromColumn, toRow, toColumn);
+            });
+        }
+        bool isSquareUnderAttack(int row, int column, Color color) const
+        {
+            return withPosition([&](const auto &pos) { return queries::isSquareUnderAttack(pos, row, column, color); });
+        }
+        bool isPieceUnderThreat(int row, int column) const
+        {
+            return withPosition([&](const auto &pos) { return queries::isPieceUnderThreat(pos, row, column); });
+        }
+        bool isKingInCheck(Color color) const
+        {
+            return withPosition([&](const auto &pos) { return pos.isInCheck(color); });
+        }
+        MoveList generateLegalMoves(Color color) const
+        {
+            MoveList moves;
+            withPosition([&](const auto &pos) { pos.generateLegalMoves(color, moves); });
+            return moves;
+        }
+
+        /**
+         * @return
+         * True if other snapshots share this snapshot's position.
+         */
+        bool isShared() const { return position.use_count() > 1; }
+
+    private:
+        std::shared_ptr<PositionVariant> position;
+    };
+}
+
+#endif
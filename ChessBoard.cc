@@ -3,53 +3,51 @@
 #include "RookPiece.hh"
 #include "BishopPiece.hh"
 #include "KingPiece.hh"
+#include "PieceRules.hh"
+#include "PositionQueries.hh"
+#include "BoardRenderer.hh"
+#include "Instrumentation.hh"
+
+#include <stdexcept>
 
 using Student::ChessBoard;
 
-std::ostringstream ChessBoard::displayBoard()
+namespace
 {
-    std::ostringstream outputString;
-    // top scale
-    outputString << "  ";
-    for (int i = 0; i < numCols; i++)
-    {
-        outputString << i;
-    }
-    outputString << std::endl
-                 << "  ";
-    // top border
-    for (int i = 0; i < numCols; i++)
+    Student::PositionVariant makePosition(int numRows, int numCols)
     {
-        outputString << "-";
-    }
-    outputString << std::endl;
-
-    for (int row = 0; row < numRows; row++)
-    {
-        outputString << row << "|";
-        for (int column = 0; column < numCols; column++)
+        // The widest position type holds 256 squares; larger boards would overrun its tables
+        constexpr int maxSquares = Student::WidePosition::Geometry::maxSquares;
+        if (numRows <= 0 || numCols <= 0 || numRows > maxSquares || numCols > maxSquares ||
+            numRows * numCols > maxSquares)
         {
-            ChessPiece *piece = board.at(row).at(column);
-            outputString << (piece == nullptr ? " " : piece->toString());
+            throw std::invalid_argument("ChessBoard: a board must have between 1 and 256 squares");
         }
-        outputString << "|" << std::endl;
-    }
-
-    // bottom border
-    outputString << "  ";
-    for (int i = 0; i < numCols; i++)
-    {
-        outputString << "-";
+        if (numRows == 8 && numCols == 8)
+        {
+            return Student::StandardPosition(Student::StandardPosition::Geometry());
+        }
+        if (numRows * numCols <= Student::NarrowPosition::Geometry::maxSquares)
+        {
+            return Student::NarrowPosition(Student::NarrowPosition::Geometry(numRows, numCols));
+        }
+        return Student::WidePosition(Student::WidePosition::Geometry(numRows, numCols));
     }
-    outputString << std::endl
-                 << std::endl;
+}
 
+std::ostringstream ChessBoard::displayBoard()
+{
+    std::ostringstream outputString;
+    // Rendered in one pass from the glyph tables, then handed to the stream at once
+    std::string text(Student::renderBound(numRows, numCols, Student::RenderUnicode), '\0');
+    text.resize(Student::renderBoard(*this, Student::RenderUnicode, &text[0], text.size()));
+    outputString << text;
     return outputString;
 
 }
 
 //Initializer 
-ChessBoard::ChessBoard(int numRow, int numCol)
+ChessBoard::ChessBoard(int numRow, int numCol) : arena(numCol), position(makePosition(numRow, numCol))
 {
     numRows = numRow;
     numCols = numCol;
@@ -61,131 +59,148 @@ ChessBoard::ChessBoard(int numRow, int numCol)
     whiteRookRightMoved = false;
     blackRookLeftMoved = false;
     blackRookRightMoved = false;
+    history.reserve(256);
+}
+
+ChessBoard::ChessBoard(const BoardSnapshot &snapshot)
+    : ChessBoard(snapshot.getNumRows(), snapshot.getNumCols())
+{
+    restore(snapshot);
+}
+
+bool ChessBoard::restore(const BoardSnapshot &snapshot)
+{
+    if (snapshot.getNumRows() != numRows || snapshot.getNumCols() != numCols)
+    {
+        return false;
+    }
+    std::uint8_t codes[BitboardTraits<WideBitboard>::capacity];
+    snapshot.withPosition([&](const auto &pos) {
+        for (int square = 0; square < numRows * numCols; square++)
+        {
+            codes[square] = pos.codeAt(square);
+            if (codes[square] != 0 && !pos.hasMoved(square))
+            {
+                codes[square] |= StandardPosition::unmovedFlag;
+            }
+        }
+    });
+    replacePieces(codes);
+    // The position is copied as it is, attack maps and key included
+    position = snapshot.getPosition();
+    turn = snapshot.getTurn();
+    return true;
+}
+
+std::unique_ptr<ChessBoard> ChessBoard::clone() const
+{
+    return std::unique_ptr<ChessBoard>(new ChessBoard(snapshot()));
 }
 
 void ChessBoard::createChessPiece(Color color, Type type, int startRow, int startColumn)
 {
+    // Moves played before an edit can no longer be taken back
+    clearHistory();
     // Check if the position is empty
     if (board.at(startRow).at(startColumn) != nullptr) {
         ChessPiece *oldPiece = board.at(startRow).at(startColumn);
-        // Remove the old piece from the pieces vector
-        for (auto iter = pieces.begin(); iter != pieces.end(); iter++) {
-            if (*iter == oldPiece) {
-                pieces.erase(iter);
-                break;
-            }
-        }
-        delete oldPiece;
+        pieces.remove(oldPiece);
+        arena.release(oldPiece);
+        withPosition([&](auto &pos) { pos.removePiece(pos.geometry().square(startRow, startColumn)); });
     }
 
-    ChessPiece *piece = nullptr;
-    switch (type)
+    ChessPiece *piece = arena.create(*this, color, type, startRow, startColumn);
+    if (type == Type::King)
     {
-    case Type::Bishop:
-        piece = new BishopPiece(*this, color, startRow, startColumn, type);
-        break;
-    case Type::Pawn:
-        piece = new PawnPiece(*this, color, startRow, startColumn, type);
-        break;
-    case Type::Rook:
-        piece = new RookPiece(*this, color, startRow, startColumn, type);
-        break;
-    case Type::King:
-        piece = new KingPiece(*this, color, startRow, startColumn, type);
         setKing(static_cast<KingPiece*>(piece), color);
-        break;
-    default:
-        break;
     }
     board.at(startRow).at(startColumn) = piece;
-    pieces.push_back(piece);
+    pieces.add(piece);
+    withPosition([&](auto &pos) { pos.putPiece(color, type, pos.geometry().square(startRow, startColumn), false); });
 }
 
-bool ChessBoard::isValidMove(int fromRow, int fromColumn, int toRow, int toColumn)
-{   
-//Check coordinate boundaries are within the board
-    if (fromRow < 0 || fromRow >= numRows || fromColumn < 0 || fromColumn >= numCols || toRow < 0 || toRow >= numRows || toColumn < 0 || toColumn >= numCols)
-    {
-        return false;
-    } 
-//Check if piece exists
-    ChessPiece *piece = board.at(fromRow).at(fromColumn);
-    if (piece == nullptr)
-    {
-        return false;
-    }
-//Check if piece is moving to the same location
-    if (fromRow == toRow && fromColumn == toColumn)
-    {
-        return false;
-    }   
-
-    ChessPiece *targetPiece = board.at(toRow).at(toColumn);
-    if (getPiece(toRow, toColumn) != nullptr && targetPiece->getColor() == piece->getColor())
+bool ChessBoard::loadPosition(const std::uint8_t *codes, Color toMove)
+{
+    int squares = numRows * numCols;
+    for (int square = 0; square < squares; square++)
     {
-        return false;
-    }
-//Check if piece can move to location
-    if (!piece->canMoveToLocation(toRow, toColumn))
+        if ((codes[square] & ~StandardPosition::unmovedFlag) > StandardPosition::maxPieceCode)
         {
             return false;
         }
-// return piece->canMoveToLocation(toRow, toColumn);
-    ChessPiece* originalTargetPiece = board.at(toRow).at(toColumn);
-    board.at(toRow).at(toColumn) = piece;
-    board.at(fromRow).at(fromColumn) = nullptr;
-    piece->setPosition(toRow, toColumn);
-
-    bool kingInCheck = isKingInCheck(piece->getColor());
-
-    board.at(fromRow).at(fromColumn) = piece;
-    board.at(toRow).at(toColumn) = originalTargetPiece;
-    piece->setPosition(fromRow, fromColumn);
-
-// If the move puts the King in check, it is invalid
-    if (kingInCheck)
-    {
-        return false;
     }
 
-// Special handling for castling
-    if (piece->getType() == King && abs(toColumn - fromColumn) == 2)
-    {
-        int row = fromRow;
-        int rookCol = (toColumn > fromColumn) ? numCols - 1 : 0;
-        ChessPiece *rook = getPiece(row, rookCol);
+    replacePieces(codes);
+    withPosition([&](auto &pos) { pos.assign(codes, toMove); });
+    turn = toMove;
+    return true;
+}
 
-        // Ensure the Rook exists and has not moved
-        if (rook == nullptr || rook->getType() != Type::Rook || rook->getColor() != piece->getColor() || rook->getHasMoved())
+void ChessBoard::replacePieces(const std::uint8_t *codes)
+{
+    clearHistory();
+    for (auto &row : board)
+    {
+        for (auto &piece : row)
         {
-            return false;
+            arena.release(piece);
+            piece = nullptr;
         }
+    }
+    pieces.clear();
+    whiteKing = nullptr;
+    blackKing = nullptr;
 
-        // Ensure the path between the King and Rook is clear
-        int step = (toColumn > fromColumn) ? 1 : -1;
-        for (int col = fromColumn + step; col != rookCol; col += step)
+    for (int square = 0; square < numRows * numCols; square++)
+    {
+        std::uint8_t code = codes[square] & ~StandardPosition::unmovedFlag;
+        if (code == 0)
         {
-            if (getPiece(row, col) != nullptr)
-            {
-                return false;
-            }
+            continue;
         }
-
-        // Ensure the King does not move through or into a square under attack
-        for (int col = fromColumn; col != toColumn + step; col += step)
+        int row = square / numCols;
+        int column = square % numCols;
+        Color color = StandardPosition::decodeColor(code);
+        Type type = StandardPosition::decodeType(code);
+        ChessPiece *piece = arena.create(*this, color, type, row, column);
+        piece->setHasMoved(!(codes[square] & StandardPosition::unmovedFlag));
+        if (type == Type::King)
         {
-            if (isSquareUnderAttack(row, col, piece->getColor()))
-            {
-                return false;
-            }
+            setKing(static_cast<KingPiece*>(piece), color);
         }
+        board[row][column] = piece;
+        pieces.add(piece);
     }
+}
 
-    return true;
+bool ChessBoard::isValidMove(int fromRow, int fromColumn, int toRow, int toColumn) const
+{
+    Student::instrumentation::count(Student::instrumentation::CountIsValidMove);
+    Student::instrumentation::ScopedTimer timer(Student::instrumentation::TimeIsValidMove);
+//Bounds, movement rules, castling conditions and king safety are checked on the bitboards
+    return withPosition([&](const auto &pos) {
+        return Student::queries::isValidMove(pos, fromRow, fromColumn, toRow, toColumn);
+    });
+}
+
+Student::MoveList ChessBoard::generateLegalMoves(Color color) const
+{
+    MoveList moves;
+    withPosition([&](const auto &pos) { pos.generateLegalMoves(color, moves); });
+    return moves;
+}
+
+Student::MoveList ChessBoard::generatePseudoLegalMoves(Color color) const
+{
+    MoveList moves;
+    withPosition([&](const auto &pos) { pos.generatePseudoLegalMoves(color, moves); });
+    return moves;
 }
 
 bool ChessBoard::movePiece(int fromRow, int fromColumn, int toRow, int toColumn)
 {
+    Student::instrumentation::count(Student::instrumentation::CountMovePiece);
+    Student::instrumentation::ScopedTimer timer(Student::instrumentation::TimeMovePiece);
     if (fromRow < 0 || fromRow >= numRows || fromColumn < 0 || fromColumn >= numCols ||
         toRow < 0 || toRow >= numRows || toColumn < 0 || toColumn >= numCols)
     {
@@ -210,27 +225,48 @@ bool ChessBoard::movePiece(int fromRow, int fromColumn, int toRow, int toColumn)
         return false;
     }
 
-    //Capture opponent piece if exists
-    if (board.at(toRow).at(toColumn) != nullptr)
+    makeMove(Move(fromRow * numCols + fromColumn, toRow * numCols + toColumn));
+    return true;
+}
+
+void ChessBoard::makeMove(Move move)
+{
+    int fromRow = move.from() / numCols;
+    int fromColumn = move.from() % numCols;
+    int toRow = move.to() / numCols;
+    int toColumn = move.to() % numCols;
+    ChessPiece *piece = board[fromRow][fromColumn];
+
+    UndoRecord record;
+    record.move = move;
+    record.captured = board[toRow][toColumn];
+    record.castlingRook = nullptr;
+    record.pieceHadMoved = piece->getHasMoved();
+    record.rookHadMoved = false;
+    record.turn = turn;
+    withPosition([&](auto &pos) { pos.makeMove(move, record.positionUndo); });
+
+    //Captured pieces are kept on the undo stack instead of being deleted
+    if (record.captured != nullptr)
     {
-       capturePiece(toRow, toColumn);
+        pieces.remove(record.captured);
     }
 
     //Move piece
-    board.at(toRow).at(toColumn) = piece;
-    board.at(fromRow).at(fromColumn) = nullptr;
+    board[toRow][toColumn] = piece;
+    board[fromRow][fromColumn] = nullptr;
     piece->setPosition(toRow, toColumn);
-
-    // Update hasMoved flag
     piece->setHasMoved(true);
 
     // Handle castling
-    if (piece->getType() == King && abs(toColumn - fromColumn) == 2) 
+    if (record.positionUndo.castled)
     {
         int rookCol = (toColumn > fromColumn) ? numCols - 1 : 0;
         int rookNewCol = (toColumn > fromColumn) ? toColumn - 1 : toColumn + 1;
 
-        ChessPiece *rook = getPiece(fromRow, rookCol);
+        ChessPiece *rook = board[fromRow][rookCol];
+        record.castlingRook = rook;
+        record.rookHadMoved = rook->getHasMoved();
         board[fromRow][rookNewCol] = rook;
         board[fromRow][rookCol] = nullptr;
         rook->setPosition(fromRow, rookNewCol);
@@ -239,42 +275,72 @@ bool ChessBoard::movePiece(int fromRow, int fromColumn, int toRow, int toColumn)
 
     // Switch turn
     turn = (turn == White) ? Black : White;
-    return true;
+    history.push_back(record);
 }
 
-bool ChessBoard::isPieceUnderThreat(int row, int column)
+bool ChessBoard::unmakeMove()
 {
-//Get target piece
-    ChessPiece *piece = board.at(row).at(column);
-//Check if piece exists   
-    if (piece == nullptr)
+    if (history.empty())
     {
         return false;
     }
-//Check if piece is under threat
-Color pieceColor = piece->getColor();
+    UndoRecord record = history.back();
+    history.pop_back();
 
-// Iterate through all cells on the chessboard
-for (int i = 0; i < numRows; i++)
-{
-    for (int j = 0; j < numCols; j++)
+    int fromRow = record.move.from() / numCols;
+    int fromColumn = record.move.from() % numCols;
+    int toRow = record.move.to() / numCols;
+    int toColumn = record.move.to() % numCols;
+
+    if (record.castlingRook != nullptr)
     {
-        // Get the piece at the current cell
-        ChessPiece *opponentPiece = board.at(i).at(j);
+        ChessPiece *rook = record.castlingRook;
+        int rookCol = (toColumn > fromColumn) ? numCols - 1 : 0;
+        board[fromRow][rook->getColumn()] = nullptr;
+        board[fromRow][rookCol] = rook;
+        rook->setPosition(fromRow, rookCol);
+        rook->setHasMoved(record.rookHadMoved);
+    }
 
-        // Check if the piece exists and is an opponent's piece
-        if (opponentPiece != nullptr && opponentPiece->getColor() != pieceColor)
-        {
-            // Check if the opponent can move to the target location
-            if (isKingSafe(i, j, row, column))
-            {
-                return true; // The target piece is under threat
-            }
-        }
+    ChessPiece *piece = board[toRow][toColumn];
+    board[fromRow][fromColumn] = piece;
+    board[toRow][toColumn] = record.captured;
+    piece->setPosition(fromRow, fromColumn);
+    piece->setHasMoved(record.pieceHadMoved);
+    if (record.captured != nullptr)
+    {
+        pieces.add(record.captured);
     }
+
+    withPosition([&](auto &pos) { pos.unmakeMove(record.move, record.positionUndo); });
+    turn = record.turn;
+    return true;
 }
 
-    return false;
+void ChessBoard::clearHistory()
+{
+    for (UndoRecord &record : history)
+    {
+        arena.release(record.captured);
+    }
+    history.clear();
+}
+
+bool ChessBoard::isPieceUnderThreat(int row, int column) const
+{
+    Student::instrumentation::count(Student::instrumentation::CountIsPieceUnderThreat);
+    Student::instrumentation::ScopedTimer timer(Student::instrumentation::TimeIsPieceUnderThreat);
+    return withPosition([&](const auto &pos) { return Student::queries::isPieceUnderThreat(pos, row, column); });
+}
+
+std::uint64_t ChessBoard::getHash() const
+{
+    return withPosition([](const auto &pos) { return pos.hash(); });
+}
+
+int ChessBoard::evaluate() const
+{
+    return withPosition([](const auto &pos) { return Student::evaluation::evaluate(pos); });
 }
 
 void ChessBoard::setKing(KingPiece* king, Color color)
@@ -289,30 +355,19 @@ void ChessBoard::setKing(KingPiece* king, Color color)
     }
 }
 
-bool ChessBoard::isKingInCheck(Color color)
+Student::KingPiece *ChessBoard::getKing(Color color) const
 {
-    KingPiece* king = (color == White) ? whiteKing : blackKing;
-
-    if (king == nullptr) return false;
+    return (color == White) ? whiteKing : blackKing;
+}
 
-    for (int i = 0; i < numRows; i++) 
-    {
-        for (int j = 0; j < numCols; j++) 
-        {
-            ChessPiece *opponentPiece = getPiece(i, j);
-            if (opponentPiece != nullptr && opponentPiece->getColor() != color) 
-            {
-                if (opponentPiece->canMoveToLocation(king->getRow(), king->getColumn())) 
-                {
-                    return true;
-                }
-            }
-        }
-    }
-    return false;
+bool ChessBoard::isKingInCheck(Color color) const
+{
+    Student::instrumentation::count(Student::instrumentation::CountIsKingInCheck);
+    Student::instrumentation::ScopedTimer timer(Student::instrumentation::TimeIsKingInCheck);
+    return withPosition([&](const auto &pos) { return pos.isInCheck(color); });
 }
 
-bool ChessBoard::isKingSafe(int fromRow, int fromColumn, int toRow, int toColumn)
+bool ChessBoard::isKingSafe(int fromRow, int fromColumn, int toRow, int toColumn) const
 {
     if (fromRow < 0 || fromRow >= numRows || fromColumn < 0 || fromColumn >= numCols ||
         toRow < 0 || toRow >= numRows || toColumn < 0 || toColumn >= numCols)
@@ -337,7 +392,7 @@ bool ChessBoard::isKingSafe(int fromRow, int fromColumn, int toRow, int toColumn
         return false;
     }
     
-    if (!piece->canMoveToLocation(toRow, toColumn))
+    if (!Student::canMoveToLocation(*piece, toRow, toColumn))
     {
         return false;
     }
@@ -348,45 +403,32 @@ bool ChessBoard::isKingSafe(int fromRow, int fromColumn, int toRow, int toColumn
 //HELPER FUNCTION: PIECE CAPTURING
 void ChessBoard::capturePiece(int row, int column)
 {
+    clearHistory();
     ChessPiece *piece = board.at(row).at(column);
-    for (auto iter = pieces.begin(); iter != pieces.end(); iter++)
+    if (piece != nullptr)
     {
-        if (*iter == piece)
-        {
-            pieces.erase(iter);
-            break;
-        }
+        pieces.remove(piece);
     }
-    delete piece;
+    arena.release(piece);
     board.at(row).at(column) = nullptr;
+    withPosition([&](auto &pos) { pos.removePiece(pos.geometry().square(row, column)); });
 }
 
 //DESTRUCTOR
 ChessBoard::~ChessBoard() {
+    clearHistory();
     for (auto& row : board) {
         for (auto& piece : row) {
-            delete piece;
+            arena.release(piece);
         }
     }
 }
 
-bool ChessBoard::isSquareUnderAttack(int row, int column, Color color)
+bool ChessBoard::isSquareUnderAttack(int row, int column, Color color) const
 {
-    for (int i = 0; i < numRows; i++)
-    {
-        for (int j = 0; j < numCols; j++)
-        {
-            ChessPiece *opponentPiece = getPiece(i, j);
-            if (opponentPiece != nullptr && opponentPiece->getColor() != color)
-            {
-                if (opponentPiece->canMoveToLocation(row, column))
-                {
-                    return true;
-                }
-            }
-        }
-    }
-    return false;
+    Student::instrumentation::count(Student::instrumentation::CountIsSquareUnderAttack);
+    Student::instrumentation::ScopedTimer timer(Student::instrumentation::TimeIsSquareUnderAttack);
+    return withPosition([&](const auto &pos) { return Student::queries::isSquareUnderAttack(pos, row, column, color); });
 }
 
 void ChessBoard::updateCastlingFlags(ChessPiece *piece, int fromColumn)
@@ -1,12 +1,18 @@
 #ifndef _CHESSBOARD_H__
 #define _CHESSBOARD_H__
 
+#include "BoardSnapshot.hh"
 #include "ChessPiece.hh"
 #include "KingPiece.hh"
+#include "PieceArena.hh"
+#include "PieceList.hh"
+#include "Position.hh"
 
 #include <list>
+#include <memory>
 #include <vector>
 #include <sstream>
+#include <variant>
 
 namespace Student
 {
@@ -30,45 +36,167 @@ namespace Student
          * *(board.at(row).at(col)) returns the ChessPiece object itself.
          */
         std::vector<std::vector<ChessPiece *>> board;
-        std::vector<ChessPiece *> pieces;
-        KingPiece *whiteKing;
-        KingPiece *blackKing;
-        
+        /**
+         * @brief
+         * The pieces on the board by colour and type, with O(1) add and
+         * remove as pieces are created, captured and restored.
+         */
+        PieceList pieces;
+        /**
+         * @brief
+         * Storage for every piece of this board. Replaced and captured
+         * pieces are released back to it instead of being deleted.
+         */
+        PieceArena arena;
+        KingPiece *whiteKing = nullptr;
+        KingPiece *blackKing = nullptr;
+
+    protected:
+        /**
+         * @brief
+         * Bitboard mirror of 'board' that move validation and attack queries
+         * run on. 8x8 boards use the compile-time StandardPosition, other
+         * boards of up to 64 squares use 64-bit masks, larger boards (up to
+         * 16x16) use WideBitboard.
+         */
+        PositionVariant position;
+
+    private:
+
+        /**
+         * @brief
+         * Everything makeMove changes, so unmakeMove can restore it.
+         * Captured pieces stay alive here until the move is taken back or
+         * the history is cleared.
+         */
+        struct UndoRecord
+        {
+            Move move;
+            ChessPiece *captured;
+            ChessPiece *castlingRook;
+            bool pieceHadMoved;
+            bool rookHadMoved;
+            Color turn;
+            MoveUndo positionUndo;
+        };
+        std::vector<UndoRecord> history;
+
+        /**
+         * @brief
+         * Releases the pieces captured by moves on the undo stack and empties it.
+         */
+        void clearHistory();
+
+        /**
+         * @brief
+         * Releases every piece and creates new ones from per-square codes,
+         * as loadPosition takes them. The bitboard position is left to the
+         * caller.
+         */
+        void replacePieces(const std::uint8_t *codes);
+
     public:
+        /**
+         * @brief
+         * Calls visitor with the bitboard position backing this board, a
+         * StandardPosition, NarrowPosition or WidePosition. This is the entry point
+         * for engine code (move generation, perft, search) that works on
+         * the bitboards directly.
+         * The const overload passes a const position. The const queries of
+         * this class only read through it, so any number of threads may
+         * query one board at a time when no thread modifies it; see
+         * SharedBoard for reading while a game is played.
+         */
+        template <class Visitor>
+        decltype(auto) withPosition(Visitor &&visitor) { return std::visit(visitor, position); }
+        template <class Visitor>
+        decltype(auto) withPosition(Visitor &&visitor) const { return std::visit(visitor, position); }
+
         /**
          * @brief
          * Allocates memory on the heap for the board.
          * Remember to initialise all pointers to nullptr.
+         * Boards may have at most 256 squares.
          * @param numRow
          * Number of rows of the chess board.
          * @param numCol
          * Number of columns of the chessboard
+         * @throws std::invalid_argument
+         * If a dimension is not positive or the board has more than 256
+         * squares, before anything is allocated for it.
          */
         ChessBoard(int numRow, int numCol);
 
+        /**
+         * @brief
+         * Builds a board holding the position of a snapshot, with an empty
+         * undo history.
+         */
+        explicit ChessBoard(const BoardSnapshot &snapshot);
+
+        /**
+         * @brief
+         * Boards cannot be copied: every piece refers back to its board.
+         * Use snapshot or clone instead.
+         */
+        ChessBoard(const ChessBoard &) = delete;
+        ChessBoard &operator=(const ChessBoard &) = delete;
+
+        /**
+         * @return
+         * A copy of the position on this board, sharing nothing with it.
+         * Costs one copy of the bitboard position.
+         */
+        BoardSnapshot snapshot() const { return BoardSnapshot(position); }
+
+        /**
+         * @brief
+         * Replaces the pieces, the side to move and the position with
+         * those of a snapshot, taken from a board of the same dimensions.
+         * Clears the undo history.
+         * @return
+         * False, leaving the board unchanged, if the dimensions differ.
+         */
+        bool restore(const BoardSnapshot &snapshot);
+
+        /**
+         * @return
+         * A new board with the same position and an empty undo history.
+         * Its pieces come from its own arena; nothing is shared with this board.
+         */
+        std::unique_ptr<ChessBoard> clone() const;
+
         /**
          * @return
          * Number of rows in chess board.
          */
-        int getNumRows() { return numRows; }
+        int getNumRows() const { return numRows; }
 
         /**
          * @return
          * Number of columns in chess board.
          */
-        int getNumCols() { return numCols; }
+        int getNumCols() const { return numCols; }
 
         /**
          * @return
          * Pointer to a piece.
          */
-        ChessPiece *getPiece(int r, int c) { return board.at(r).at(c); }
+        ChessPiece *getPiece(int r, int c) const { return board.at(r).at(c); }
+
+        /**
+         * @return
+         * The pieces of one colour and type on the board, in no particular
+         * order, without scanning the squares.
+         */
+        const std::vector<ChessPiece *> &getPieces(Color color, Type type) const { return pieces.of(color, type); }
 
         /**
          * @brief
          * Allocates memory for a new chess piece and assigns its
          * address to the corresponding pointer in the 'board' variable.
          * Remove any existing piece first before adding the new piece.
+         * Clears the undo history.
          * @param col
          * Color of the piece to be created.
          * @param ty
@@ -99,6 +227,44 @@ namespace Student
          */
         bool movePiece(int fromRow, int fromColumn, int toRow, int toColumn);
 
+        /**
+         * @brief
+         * Performs a move without validating it and records it on the undo
+         * stack. A captured piece is kept on the stack rather than deleted,
+         * so the move can be taken back without allocating.
+         * @param move
+         * A legal move, e.g. from generateLegalMoves.
+         */
+        void makeMove(Move move);
+
+        /**
+         * @brief
+         * Takes back the last move made with makeMove or movePiece,
+         * restoring the captured piece, the castling rook, the hasMoved
+         * flags and the turn.
+         * @return
+         * False if there is no move to take back.
+         */
+        bool unmakeMove();
+
+        /**
+         * @brief
+         * Replaces every piece on the board, and the side to move, with the
+         * contents of a decoded position. Pieces come straight from the
+         * arena and the bitboards are rebuilt in one pass, without the
+         * per-piece work of createChessPiece. Clears the undo history.
+         * @param codes
+         * numRows * numCols piece codes in square order (row * getNumCols()
+         * + column), as BasicPosition::assign takes them: 0 for an empty
+         * square, otherwise encode(color, type), with unmovedFlag set if the
+         * piece has not moved.
+         * @param toMove
+         * The side to move.
+         * @return
+         * False, leaving the board unchanged, if a code is invalid.
+         */
+        bool loadPosition(const std::uint8_t *codes, Color toMove);
+
         /**
          * @brief
          * Checks if a move is valid without accounting for turns.
@@ -113,7 +279,29 @@ namespace Student
          * @return
          * Returns true if move may be executed without accounting for turn.
          */
-        bool isValidMove(int fromRow, int fromColumn, int toRow, int toColumn);
+        bool isValidMove(int fromRow, int fromColumn, int toRow, int toColumn) const;
+
+        /**
+         * @brief
+         * Lists every legal move of the given colour without accounting for
+         * turn. Moves use square indices row * getNumCols() + column.
+         * @param color
+         * Colour of the pieces to be moved.
+         * @return
+         * A stack-allocated list of the legal moves.
+         */
+        MoveList generateLegalMoves(Color color) const;
+
+        /**
+         * @brief
+         * Lists every move of the given colour that follows the movement
+         * rules of its piece, including moves that leave its own king in check.
+         * @param color
+         * Colour of the pieces to be moved.
+         * @return
+         * A stack-allocated list of the pseudo-legal moves.
+         */
+        MoveList generatePseudoLegalMoves(Color color) const;
 
         /**
          * @brief
@@ -128,13 +316,29 @@ namespace Student
          * Returns true if a piece exists at the stated position, and an opponent
          * piece may move to the position.
          */
-        bool isPieceUnderThreat(int row, int column);
+        bool isPieceUnderThreat(int row, int column) const;
+
+        /**
+         * @return
+         * 64-bit Zobrist key of the pieces, the side to move and the castling
+         * rights. Maintained incrementally, so this is O(1).
+         */
+        std::uint64_t getHash() const;
+
+        /**
+         * @return
+         * Static evaluation in centipawns from the point of view of the side
+         * to move. Material and piece placement are kept up to date by every
+         * change to the board, so this only adds the pawn structure and
+         * king safety terms.
+         */
+        int evaluate() const;
 
         /**
          * @brief
          * Returns an output string stream displaying the layout of the board.
-         * An ostringstream is used to automatically handle formatting of integers
-         * and special characters into their string representations.
+         * The text is rendered by renderBoard in RenderUnicode format; call
+         * renderBoard directly to render into a buffer without allocating.
          * @return
          * An output stream containing the full board layout.
          */
@@ -145,6 +349,7 @@ namespace Student
         /** 
          * @brief
          * Captures a piece at the given row and column. And deals with the removal/deletion of the piece.
+         * Clears the undo history.
          * @param row
          * The row of the piece to be captured.
          * @param column
@@ -153,10 +358,10 @@ namespace Student
         void capturePiece(int row, int column); 
         
         void setKing(KingPiece* king, Color color);
-        KingPiece *getKing(Color color);
-        bool isKingInCheck(Color color);
-        bool isKingSafe(int fromRow, int fromColumn, int toRow, int toColumn);
-        bool isSquareUnderAttack(int row, int column, Color color);
+        KingPiece *getKing(Color color) const;
+        bool isKingInCheck(Color color) const;
+        bool isKingSafe(int fromRow, int fromColumn, int toRow, int toColumn) const;
+        bool isSquareUnderAttack(int row, int column, Color color) const;
         void updateCastlingFlags(ChessPiece *piece, int fromColumn);
         //DESTRUCTOR
         ~ChessBoard();
@@ -0,0 +1,115 @@
+#ifndef __CHESSBOARDT_H__
+#define __CHESSBOARDT_H__
+
+#include "ChessBoard.hh"
+#include "Instrumentation.hh"
+#include "PositionQueries.hh"
+
+#include <cstdint>
+#include <type_traits>
+
+namespace Student
+{
+    /**
+     * @brief
+     * The position type backing a Rows x Cols ChessBoard: StandardPosition
+     * for 8x8, otherwise the runtime-sized position for that many squares.
+     */
+    template <int Rows, int Cols>
+    using PositionFor = std::conditional_t<Rows == 8 && Cols == 8, StandardPosition,
+                                           std::conditional_t<(Rows * Cols <= 64), NarrowPosition, WidePosition>>;
+
+    /**
+     * @brief
+     * ChessBoard with its dimensions fixed at compile time.
+     * It is a ChessBoard, so pieces and every ChessBoard function work
+     * unchanged, while the queries declared here reach the position
+     * without the variant dispatch and check bounds against constants.
+     * ChessBoardT<8, 8> runs on StandardPosition, whose geometry is
+     * entirely constexpr.
+     */
+    template <int Rows, int Cols>
+    class ChessBoardT : public ChessBoard
+    {
+        static_assert(Rows > 0 && Cols > 0 && Rows * Cols <= BitboardTraits<WideBitboard>::capacity,
+                      "a board holds at most 256 squares");
+
+    public:
+        using Position = PositionFor<Rows, Cols>;
+
+        static constexpr int rows = Rows;
+        static constexpr int cols = Cols;
+
+        ChessBoardT() : ChessBoard(Rows, Cols) {}
+
+        static constexpr bool contains(int row, int column)
+        {
+            return row >= 0 && row < Rows && column >= 0 && column < Cols;
+        }
+
+        static constexpr int square(int row, int column) { return row * Cols + column; }
+
+        /**
+         * @return
+         * The position backing this board. The constructor guarantees
+         * which alternative of the variant holds it.
+         */
+        Position &getPosition() { return *std::get_if<Position>(&position); }
+        const Position &getPosition() const { return *std::get_if<Position>(&position); }
+
+        /**
+         * @brief
+         * Like ChessBoard::withPosition, but calls visitor with the one
+         * position type this board can have.
+         */
+        template <class Visitor>
+        decltype(auto) withPosition(Visitor &&visitor) { return visitor(getPosition()); }
+        template <class Visitor>
+        decltype(auto) withPosition(Visitor &&visitor) const { return visitor(getPosition()); }
+
+        // These answer as their ChessBoard namesakes do, through the same
+        // queries functions and instrumentation hooks, on the known position type
+
+        bool isValidMove(int fromRow, int fromColumn, int toRow, int toColumn) const
+        {
+            instrumentation::count(instrumentation::CountIsValidMove);
+            instrumentation::ScopedTimer timer(instrumentation::TimeIsValidMove);
+            return queries::isValidMove(getPosition(), fromRow, fromColumn, toRow, toColumn);
+        }
+
+        bool isSquareUnderAttack(int row, int column, Color color) const
+        {
+            instrumentation::count(instrumentation::CountIsSquareUnderAttack);
+            instrumentation::ScopedTimer timer(instrumentation::TimeIsSquareUnderAttack);
+            return queries::isSquareUnderAttack(getPosition(), row, column, color);
+        }
+
+        bool isPieceUnderThreat(int row, int column) const
+        {
+            instrumentation::count(instrumentation::CountIsPieceUnderThreat);
+            instrumentation::ScopedTimer timer(instrumentation::TimeIsPieceUnderThreat);
+            return queries::isPieceUnderThreat(getPosition(), row, column);
+        }
+
+        bool isKingInCheck(Color color) const
+        {
+            instrumentation::count(instrumentation::CountIsKingInCheck);
+            instrumentation::ScopedTimer timer(instrumentation::TimeIsKingInCheck);
+            return getPosition().isInCheck(color);
+        }
+
+        MoveList generateLegalMoves(Color color) const
+        {
+            MoveList moves;
+            getPosition().generateLegalMoves(color, moves);
+            return moves;
+        }
+
+        std::uint64_t getHash() const { return getPosition().hash(); }
+    };
+
+    /** The standard board, the fully specialised path. */
+    using StandardChessBoard = ChessBoardT<8, 8>;
+}
+
+#endif
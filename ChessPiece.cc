@@ -11,11 +11,6 @@ namespace Student
         return color;
     }
     
-    Type ChessPiece::getType()
-    {
-        return type;
-    }
-    
     int ChessPiece::getRow()
     {
         return row;
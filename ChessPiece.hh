@@ -6,18 +6,23 @@
     namespace Student
 {
   class ChessBoard;
+  class PieceList;
 
   class ChessPiece
   {
+    friend class PieceList;
+    int listSlot = -1; // Index in its board's PieceList, -1 when not listed
+
   protected:
     bool hasMoved = false; // Tracks if the piece has moved
+    bool standardRules = false; // Set by the built-in piece classes
 
   public:
     ChessBoard &board;  // Reference to the chessboard
     Color color;        // Color of the piece (white/black)
     int row;            // Current row position
     int column;         // Current column position
-    Type type;         // Type of the piece
+    const Type type;   // Type of the piece, fixed at construction
 
     /**
      * @brief
@@ -47,13 +52,23 @@
 
     /**
      * @return
-     * Type of piece.
+     * Type of piece, as passed to the constructor.
      *
-     * Note: An alternate perhaps more ideal way of implementation
-     * would have been to define this function as pure virtual and
-     * let each derived class override this function.
+     * Final, so a derived class that tries to override it fails to
+     * compile instead of silently getting the rules of the constructor's
+     * type; calls through a base pointer can still be inlined. Both
+     * signatures are declared so neither can be overridden.
+     */
+    virtual Type getType() final { return type; }
+    virtual Type getType() const final { return type; }
+
+    /**
+     * @return
+     * True for the built-in piece classes, whose movement rule is
+     * PieceRules<getType()>. Custom pieces keep this false and are
+     * checked through canMoveToLocation.
      */
-    virtual Type getType();
+    bool hasStandardRules() const { return standardRules; }
 
     /**
      * @return
@@ -0,0 +1,72 @@
+#include "Evaluation.hh"
+
+#include <cstdlib>
+
+namespace Student
+{
+    namespace evaluation
+    {
+        namespace
+        {
+            /**
+             * @return
+             * Placement bonus of a White piece; Black uses the mirrored row.
+             * Distances are in half squares so both even and odd board
+             * sides have a centre.
+             */
+            int placement(Type type, int row, int column, int numRows, int numCols)
+            {
+                int columnSpan = numCols > 1 ? numCols - 1 : 1;
+                int rowSpan = numRows > 1 ? numRows - 1 : 1;
+                int columnFromCentre = std::abs(2 * column - (numCols - 1));
+                int rowFromCentre = std::abs(2 * row - (numRows - 1));
+                switch (type)
+                {
+                case Pawn:
+                {
+                    // Rows advanced from the starting row, worth up to 50 at the far end
+                    int advanced = (numRows - 2) - row;
+                    int advance = numRows > 2 && advanced > 0 ? 50 * advanced / (numRows - 2) : 0;
+                    return advance + 10 * (columnSpan - columnFromCentre) / columnSpan;
+                }
+                case Rook:
+                    // The row the enemy pawns start on
+                    return (row == 1 ? 20 : 0) + 5 * (columnSpan - columnFromCentre) / columnSpan;
+                case Bishop:
+                    return 10 - 20 * (columnFromCentre + rowFromCentre) / (columnSpan + rowSpan);
+                case King:
+                    // Stay on the back row and away from the central columns
+                    return -10 * ((numRows - 1) - row) + 10 * columnFromCentre / columnSpan;
+                default:
+                    return 0;
+                }
+            }
+
+            void build(PieceSquareTable &table, int numRows, int numCols)
+            {
+                table = PieceSquareTable{};
+                for (int color = Black; color <= White; color++)
+                {
+                    for (int type = Pawn; type <= King; type++)
+                    {
+                        int code = 1 + color * 4 + type;
+                        for (int row = 0; row < numRows; row++)
+                        {
+                            int whiteRow = (color == White) ? row : numRows - 1 - row;
+                            for (int column = 0; column < numCols; column++)
+                            {
+                                int value = pieceValues[type] + placement(Type(type), whiteRow, column, numRows, numCols);
+                                table.value[code][row * numCols + column] = std::int16_t(color == White ? value : -value);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        const PieceSquareTable &pieceSquareTable(int numRows, int numCols)
+        {
+            return geometry::cachedTable<PieceSquareTable, ZobristKeys::squares>(numRows, numCols, build);
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef __EVALUATION_H__
+#define __EVALUATION_H__
+
+#include "Attacks.hh"
+#include "Zobrist.hh"
+
+#include <cstdint>
+
+namespace Student
+{
+    /**
+     * @brief
+     * Material plus placement value of every piece code on every square
+     * of one board size, from White's point of view: White pieces score
+     * positive, Black pieces negative, and Black's values mirror White's
+     * top to bottom. BasicPosition adds and subtracts entries as pieces
+     * are put and removed, so the sum is always current.
+     */
+    struct PieceSquareTable
+    {
+        std::int16_t value[ZobristKeys::pieceCodes][ZobristKeys::squares];
+    };
+
+    namespace evaluation
+    {
+        /** Indexed by Type: Pawn, Rook, Bishop, King. */
+        constexpr int pieceValues[4] = {100, 500, 330, 0};
+
+        // Pawn structure and king safety weights
+        constexpr int doubledPawn = -15;
+        constexpr int isolatedPawn = -10;
+        constexpr int passedPawn = 20;
+        constexpr int attackedKingSquare = -8;
+        constexpr int pawnShield = 6;
+
+        /**
+         * @return
+         * The table for a numRows x numCols board, built on first use and
+         * shared by every position of that size. Safe to call from any thread.
+         */
+        const PieceSquareTable &pieceSquareTable(int numRows, int numCols);
+
+        /**
+         * @return
+         * Doubled, isolated and passed pawn terms of one side, in bitboard
+         * operations over its whole pawn set.
+         */
+        template <class Position>
+        int pawnStructure(const Position &pos, Color color)
+        {
+            using Bitboard = typename Position::Bitboard;
+            const auto &geo = pos.geometry();
+            Bitboard all = geo.all();
+            Bitboard pawns = pos.pieces(color, Pawn);
+            Bitboard enemyPawns = pos.pieces(opponent(color), Pawn);
+            Direction ahead = attacks::pawnPush(color);
+            Direction behind = attacks::pawnPush(opponent(color));
+
+            // Pawns with another pawn of their side in front of them
+            Bitboard doubled = pawns & attacks::slide(geo, pawns, behind, all);
+            Bitboard columns = pawns | attacks::slide(geo, pawns, ahead, all) | attacks::slide(geo, pawns, behind, all);
+            Bitboard neighbours = attacks::step(geo, columns, East) | attacks::step(geo, columns, West);
+            // Squares an enemy pawn stands on, guards from the front, or blocks
+            Bitboard blocked = enemyPawns | attacks::slide(geo, enemyPawns, behind, all);
+            blocked |= attacks::step(geo, blocked, East) | attacks::step(geo, blocked, West);
+
+            return doubledPawn * bits::popCount(doubled) +
+                   isolatedPawn * bits::popCount(pawns & ~neighbours) +
+                   passedPawn * bits::popCount(pawns & ~blocked);
+        }
+
+        /**
+         * @return
+         * King safety of one side: a penalty for every square around its
+         * king that the opponent attacks and a bonus for its pawns there.
+         * Reads the incrementally kept attack maps.
+         */
+        template <class Position>
+        int kingSafety(const Position &pos, Color color)
+        {
+            auto zone = attacks::king(pos.geometry(), pos.pieces(color, King));
+            return attackedKingSquare * bits::popCount(zone & pos.attackedSquares(opponent(color))) +
+                   pawnShield * bits::popCount(zone & pos.pieces(color, Pawn));
+        }
+
+        /**
+         * @return
+         * Static evaluation from the point of view of the side to move:
+         * the incrementally kept material and piece-square sum plus the
+         * pawn structure and king safety terms.
+         */
+        template <class Position>
+        int evaluate(const Position &pos)
+        {
+            int score = pos.pieceSquareScore() +
+                        pawnStructure(pos, White) - pawnStructure(pos, Black) +
+                        kingSafety(pos, White) - kingSafety(pos, Black);
+            return pos.sideToMove() == White ? score : -score;
+        }
+    }
+}
+
+#endif
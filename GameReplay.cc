@@ -0,0 +1,59 @@
+#include "GameReplay.hh"
+#include "ThreadPool.hh"
+
+#include <algorithm>
+#include <thread>
+#include <type_traits>
+
+namespace Student
+{
+    ReplayResult replayGame(ChessBoard &board, const Move *moves, std::size_t count)
+    {
+        ReplayResult result;
+        for (; result.movesPlayed < count; result.movesPlayed++)
+        {
+            Move move = moves[result.movesPlayed];
+            result.status = board.withPosition([&](const auto &pos) {
+                return pos.classifyMove(move, pos.checkInfo(pos.sideToMove()));
+            });
+            if (result.status != MoveOk)
+            {
+                break;
+            }
+            board.makeMove(move);
+        }
+        return result;
+    }
+
+    std::vector<ReplayResult> replayGames(ChessBoard &start, const std::vector<GameLog> &games, int threads)
+    {
+        std::vector<ReplayResult> results(games.size());
+        if (games.empty())
+        {
+            return results;
+        }
+
+        ThreadPool pool(threads > 0 ? threads : int(std::thread::hardware_concurrency()));
+        // Several games per task keep the queueing cost small next to the replay
+        std::size_t gamesPerTask = std::max<std::size_t>(1, games.size() / (8 * pool.getThreadCount()));
+
+        start.withPosition([&](const auto &startPosition) {
+            using Position = std::decay_t<decltype(startPosition)>;
+            std::vector<Position> scratch(pool.getThreadCount(), startPosition);
+            for (std::size_t first = 0; first < games.size(); first += gamesPerTask)
+            {
+                std::size_t last = std::min(games.size(), first + gamesPerTask);
+                pool.submit([&, first, last](int worker) {
+                    Position &position = scratch[worker];
+                    for (std::size_t game = first; game < last; game++)
+                    {
+                        position = startPosition;
+                        results[game] = replayMoves(position, games[game].moves, games[game].count);
+                    }
+                });
+            }
+            pool.wait();
+        });
+        return results;
+    }
+}
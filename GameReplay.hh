@@ -0,0 +1,86 @@
+#ifndef __GAMEREPLAY_H__
+#define __GAMEREPLAY_H__
+
+#include "ChessBoard.hh"
+
+#include <cstddef>
+#include <vector>
+
+namespace Student
+{
+    /**
+     * @brief
+     * Outcome of replaying a recorded game.
+     */
+    struct ReplayResult
+    {
+        /**
+         * Number of moves played. If status is not MoveOk, this is also
+         * the index of the first illegal move.
+         */
+        std::size_t movesPlayed = 0;
+        MoveStatus status = MoveOk;
+    };
+
+    /**
+     * @brief
+     * A recorded game: a contiguous array of moves, the first one played
+     * by the side to move of the starting position.
+     */
+    struct GameLog
+    {
+        const Move *moves;
+        std::size_t count;
+    };
+
+    /**
+     * @brief
+     * Validates and plays a sequence of moves on a position, stopping at
+     * the first illegal one. The position is left after the last legal
+     * move; no undo information is kept.
+     */
+    template <class Position>
+    ReplayResult replayMoves(Position &position, const Move *moves, std::size_t count)
+    {
+        ReplayResult result;
+        MoveUndo undo;
+        for (; result.movesPlayed < count; result.movesPlayed++)
+        {
+            Move move = moves[result.movesPlayed];
+            result.status = position.classifyMove(move, position.checkInfo(position.sideToMove()));
+            if (result.status != MoveOk)
+            {
+                break;
+            }
+            position.makeMove(move, undo);
+        }
+        return result;
+    }
+
+    /**
+     * @brief
+     * Plays a recorded game on a board with the checks of movePiece, in a
+     * single pass without per-call bounds and turn lookups through the
+     * pieces. The board is left after the last legal move, and every
+     * played move can be taken back with unmakeMove.
+     * @param moves
+     * Moves in square indices of this board (row * getNumCols() + column).
+     */
+    ReplayResult replayGame(ChessBoard &board, const Move *moves, std::size_t count);
+
+    /**
+     * @brief
+     * Validates many recorded games from a common starting position on a
+     * thread pool. Each worker replays its games on its own copy of the
+     * starting position; the board itself is not modified.
+     * @param start
+     * The position every game starts from.
+     * @param threads
+     * Worker threads; 0 uses every hardware thread.
+     * @return
+     * One result per game, in the order of games.
+     */
+    std::vector<ReplayResult> replayGames(ChessBoard &start, const std::vector<GameLog> &games, int threads);
+}
+
+#endif
@@ -0,0 +1,176 @@
+#include "Instrumentation.hh"
+
+#include <mutex>
+#include <vector>
+
+namespace Student
+{
+    namespace instrumentation
+    {
+        namespace
+        {
+            const char *const counterNames[CounterCount] = {
+                "isValidMove",
+                "movePiece",
+                "isKingInCheck",
+                "isSquareUnderAttack",
+                "isPieceUnderThreat",
+                "canMoveToLocation.pawn",
+                "canMoveToLocation.rook",
+                "canMoveToLocation.bishop",
+                "canMoveToLocation.king",
+                "squaresScanned",
+                "attackMapUpdates",
+            };
+
+            const char *const timerNames[TimerCount] = {
+                "isValidMove",
+                "movePiece",
+                "isKingInCheck",
+                "isSquareUnderAttack",
+                "isPieceUnderThreat",
+            };
+
+            /**
+             * @brief
+             * Every thread's counters. Blocks are never freed, so the counts
+             * of finished threads stay in the totals.
+             */
+            struct Registry
+            {
+                std::mutex mutex;
+                std::vector<ThreadCounters *> threads;
+                Snapshot baseline{};
+            };
+
+            Registry &registry()
+            {
+                static Registry *instance = new Registry;
+                return *instance;
+            }
+
+            /** Sum over all threads, not counting the baseline. Call with the mutex held. */
+            Snapshot totals(const Registry &reg)
+            {
+                Snapshot sum{};
+                for (const ThreadCounters *thread : reg.threads)
+                {
+                    for (int counter = 0; counter < CounterCount; counter++)
+                    {
+                        sum.counts[counter] += thread->counts[counter].load(std::memory_order_relaxed);
+                    }
+                    for (int timer = 0; timer < TimerCount; timer++)
+                    {
+                        for (int bucket = 0; bucket < histogramBuckets; bucket++)
+                        {
+                            sum.histograms[timer][bucket] += thread->histograms[timer][bucket].load(std::memory_order_relaxed);
+                        }
+                    }
+                }
+                return sum;
+            }
+
+            void appendNumber(std::string &out, std::uint64_t value)
+            {
+                char digits[20];
+                int length = 0;
+                do
+                {
+                    digits[length++] = char('0' + value % 10);
+                    value /= 10;
+                } while (value != 0);
+                while (length > 0)
+                {
+                    out += digits[--length];
+                }
+            }
+
+            void appendName(std::string &out, const char *name)
+            {
+                out += '"';
+                out += name;
+                out += "\":";
+            }
+        }
+
+        ThreadCounters &threadCounters()
+        {
+            thread_local ThreadCounters *local = nullptr;
+            if (local == nullptr)
+            {
+                ThreadCounters *counters = new ThreadCounters();
+                Registry &reg = registry();
+                std::lock_guard<std::mutex> lock(reg.mutex);
+                reg.threads.push_back(counters);
+                local = counters;
+            }
+            return *local;
+        }
+
+        Snapshot snapshot()
+        {
+            Registry &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            Snapshot result = totals(reg);
+            for (int counter = 0; counter < CounterCount; counter++)
+            {
+                result.counts[counter] -= reg.baseline.counts[counter];
+            }
+            for (int timer = 0; timer < TimerCount; timer++)
+            {
+                for (int bucket = 0; bucket < histogramBuckets; bucket++)
+                {
+                    result.histograms[timer][bucket] -= reg.baseline.histograms[timer][bucket];
+                }
+            }
+            return result;
+        }
+
+        void reset()
+        {
+            Registry &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.baseline = totals(reg);
+        }
+
+        std::string toJson(const Snapshot &snapshot)
+        {
+            std::string out;
+            out.reserve(2048);
+            out += "{\"enabled\":";
+            out += enabled ? "true" : "false";
+            out += ",\"counters\":{";
+            for (int counter = 0; counter < CounterCount; counter++)
+            {
+                if (counter > 0)
+                    out += ',';
+                appendName(out, counterNames[counter]);
+                appendNumber(out, snapshot.counts[counter]);
+            }
+            out += "},\"histograms\":{";
+            for (int timer = 0; timer < TimerCount; timer++)
+            {
+                if (timer > 0)
+                    out += ',';
+                appendName(out, timerNames[timer]);
+                std::uint64_t total = 0;
+                for (int bucket = 0; bucket < histogramBuckets; bucket++)
+                {
+                    total += snapshot.histograms[timer][bucket];
+                }
+                out += "{\"count\":";
+                appendNumber(out, total);
+                out += ",\"bucketsNs\":[";
+                for (int bucket = 0; bucket < histogramBuckets; bucket++)
+                {
+                    if (bucket > 0)
+                        out += ',';
+                    appendNumber(out, snapshot.histograms[timer][bucket]);
+                }
+                out += "]}";
+            }
+            out += "}}";
+            return out;
+        }
+    }
+}
@@ -0,0 +1,165 @@
+#ifndef __INSTRUMENTATION_H__
+#define __INSTRUMENTATION_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * Build with -DCHESS_INSTRUMENTATION=1 to count and time the rules engine.
+ * Otherwise every hook below compiles to nothing.
+ */
+#ifndef CHESS_INSTRUMENTATION
+#define CHESS_INSTRUMENTATION 0
+#endif
+
+namespace Student
+{
+    namespace instrumentation
+    {
+        constexpr bool enabled = CHESS_INSTRUMENTATION != 0;
+
+        enum Counter
+        {
+            CountIsValidMove,
+            CountMovePiece,
+            CountIsKingInCheck,
+            CountIsSquareUnderAttack,
+            CountIsPieceUnderThreat,
+            /** canMoveToLocation calls, one counter per Type. */
+            CountPawnRules,
+            CountRookRules,
+            CountBishopRules,
+            CountKingRules,
+            /** Squares the movement rules checked for blockers. */
+            CountSquaresScanned,
+            /** Squares whose attacker counts were updated by piece changes. */
+            CountAttackMapUpdates,
+            CounterCount,
+        };
+
+        enum Timer
+        {
+            TimeIsValidMove,
+            TimeMovePiece,
+            TimeIsKingInCheck,
+            TimeIsSquareUnderAttack,
+            TimeIsPieceUnderThreat,
+            TimerCount,
+        };
+
+        /** Bucket b of a histogram counts durations in [2^(b-1), 2^b) ns; bucket 0 counts 0 ns. */
+        constexpr int histogramBuckets = 32;
+
+        /**
+         * @brief
+         * One thread's counters. Each thread writes only its own block, in
+         * its own cache lines, with plain relaxed loads and stores.
+         */
+        struct alignas(64) ThreadCounters
+        {
+            std::atomic<std::uint64_t> counts[CounterCount];
+            std::atomic<std::uint64_t> histograms[TimerCount][histogramBuckets];
+        };
+
+        /**
+         * @return
+         * The calling thread's counters, registered on first use.
+         */
+        ThreadCounters &threadCounters();
+
+        inline void bump(std::atomic<std::uint64_t> &counter, std::uint64_t amount)
+        {
+            // Only the owning thread writes, so no read-modify-write is needed
+            counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        inline void count(Counter counter, std::uint64_t amount = 1)
+        {
+            if constexpr (enabled)
+            {
+                bump(threadCounters().counts[counter], amount);
+            }
+        }
+
+        inline int bucketOf(std::uint64_t nanoseconds)
+        {
+            int bucket = nanoseconds == 0 ? 0 : 64 - __builtin_clzll(nanoseconds);
+            return bucket < histogramBuckets ? bucket : histogramBuckets - 1;
+        }
+
+        inline void record(Timer timer, std::uint64_t nanoseconds)
+        {
+            if constexpr (enabled)
+            {
+                bump(threadCounters().histograms[timer][bucketOf(nanoseconds)], 1);
+            }
+        }
+
+        /**
+         * @brief
+         * Records the lifetime of the object in a latency histogram.
+         */
+        class ScopedTimer
+        {
+        public:
+            explicit ScopedTimer(Timer timer) : timer(timer)
+            {
+                if constexpr (enabled)
+                {
+                    start = std::chrono::steady_clock::now();
+                }
+            }
+
+            ~ScopedTimer()
+            {
+                if constexpr (enabled)
+                {
+                    auto elapsed = std::chrono::steady_clock::now() - start;
+                    record(timer, std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+                }
+            }
+
+            ScopedTimer(const ScopedTimer &) = delete;
+            ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+        private:
+            Timer timer;
+            std::chrono::steady_clock::time_point start;
+        };
+
+        /**
+         * @brief
+         * Totals over every thread since the last reset.
+         */
+        struct Snapshot
+        {
+            std::uint64_t counts[CounterCount];
+            std::uint64_t histograms[TimerCount][histogramBuckets];
+        };
+
+        /**
+         * @return
+         * The counters summed over all threads, minus their values at the
+         * last reset. Safe to call while other threads are counting.
+         */
+        Snapshot snapshot();
+
+        /**
+         * @brief
+         * Starts counting from zero. Threads keep counting undisturbed;
+         * the current totals become the baseline later snapshots subtract.
+         */
+        void reset();
+
+        /**
+         * @return
+         * The snapshot as a JSON object: "enabled", "counters" by name, and
+         * "histograms" by name, each with its total count and its buckets.
+         */
+        std::string toJson(const Snapshot &snapshot);
+    }
+}
+
+#endif
@@ -9,17 +9,12 @@
  */
 namespace Student
 {
-    class KingPiece : public ChessPiece
+    class KingPiece final : public ChessPiece
     {
     public:
         KingPiece(ChessBoard &board, Color color, int row, int column, Type type);
         bool canMoveToLocation(int toRow, int toColumn) override;
         const char *toString() override;
-        virtual Type getType() override { return Type::King; };
-
-    private:
-        bool canCastle(int toColumn);
-        bool hasMoved = false;
     };
 }
 
@@ -0,0 +1,131 @@
+#include "Magic.hh"
+#include "BoardGeometry.hh"
+
+namespace Student
+{
+    namespace magic
+    {
+        namespace
+        {
+            using Geometry = StaticGeometry<8, 8>;
+
+            const Direction rookDirections[4] = {North, South, East, West};
+            const Direction bishopDirections[4] = {NorthEast, NorthWest, SouthEast, SouthWest};
+
+            /**
+             * Multipliers that map the relevant occupancies of each square
+             * to distinct table entries, or entries with equal attack
+             * sets. Found once by a random search over sparse candidates.
+             */
+            const Bitboard rookMultipliers[64] = {
+                0x6100102040800100ULL, 0x0440004020001002ULL, 0x2180100120008009ULL, 0x2100090010002006ULL,
+                0x8480140042803800ULL, 0x0200040200080110ULL, 0x0080020000800100ULL, 0x4200004120811604ULL,
+                0x0881800040008068ULL, 0x0000402010004002ULL, 0x8000802000801008ULL, 0x0020800800801000ULL,
+                0x0204808004004800ULL, 0x0000800200800400ULL, 0x0002000401420048ULL, 0x081A0010840108C2ULL,
+                0x0080008020400080ULL, 0x8090004040002000ULL, 0x0000888020001003ULL, 0x0000808008001001ULL,
+                0x4084018028008480ULL, 0x0000808004000200ULL, 0x4068040008900201ULL, 0x000002000900804CULL,
+                0x2040400480008028ULL, 0x200B200040055001ULL, 0x0040200280100080ULL, 0x9010100100090020ULL,
+                0x1008040080080080ULL, 0x8202040080800200ULL, 0x2424010080800200ULL, 0x4008004200010084ULL,
+                0x0410400820800092ULL, 0x0100400080802004ULL, 0x8020200041001900ULL, 0x0048010010100200ULL,
+                0x0800080085001100ULL, 0x0000800200800400ULL, 0x9000100804000201ULL, 0x022C040042000889ULL,
+                0x1200800040018022ULL, 0x001000200040400AULL, 0x1420008010008021ULL, 0x0B68001000808008ULL,
+                0xE400050008010010ULL, 0x2404000200048080ULL, 0x0000084182040030ULL, 0x1600004081020004ULL,
+                0x0000410080002500ULL, 0x0020400020008080ULL, 0x0000100080200080ULL, 0x2010104200082200ULL,
+                0x0008008008040080ULL, 0x0244000402008080ULL, 0x0401000200140500ULL, 0x0401404C01008600ULL,
+                0x0104820040201106ULL, 0x0000110042002082ULL, 0x0002090110200041ULL, 0x0014042008100101ULL,
+                0x0012001088A00402ULL, 0x0282000810048102ULL, 0x010848901201080CULL, 0x0000040900224282ULL
+            };
+
+            const Bitboard bishopMultipliers[64] = {
+                0x8010041140440100ULL, 0x0804100091010082ULL, 0x0088008102100000ULL, 0x080C2C0884020400ULL,
+                0x0602021007020080ULL, 0x9481042104180800ULL, 0x0115090882400800ULL, 0x0000808401200240ULL,
+                0x0000102088010050ULL, 0x0000433808038288ULL, 0x000810810A002014ULL, 0x3402022086000002ULL,
+                0x801B060A10800000ULL, 0x0A24809004200004ULL, 0x4040128401205118ULL, 0x14C202004404B401ULL,
+                0x084A08102081040BULL, 0x0811402062108100ULL, 0x02280404004C0208ULL, 0x2048000420421002ULL,
+                0x01A4081880A00008ULL, 0x08510081300A1002ULL, 0x2002118682012004ULL, 0x0019020080A81104ULL,
+                0x0020040091104200ULL, 0x0408022021120204ULL, 0x1200280004080025ULL, 0x508108001C0204A0ULL,
+                0x8001010020104000ULL, 0x20080200C04100A0ULL, 0x0080841030820810ULL, 0x08060D2042032100ULL,
+                0x0804108840042048ULL, 0x0308340240102211ULL, 0x0402404040180200ULL, 0x0002004041040100ULL,
+                0x0401080200002200ULL, 0x6020008100002404ULL, 0x4810842080210084ULL, 0x9011020A0C082110ULL,
+                0x0400A410080A4200ULL, 0x0302091062148810ULL, 0x8101008050040100ULL, 0x0480002018040100ULL,
+                0x0C10C0014A000301ULL, 0x0020081010414022ULL, 0x040410C401002045ULL, 0x1004011403290100ULL,
+                0x0004010110D00160ULL, 0x0000806402200100ULL, 0x0020002221100106ULL, 0x2000104842022210ULL,
+                0x0030064048220232ULL, 0x0000448408020800ULL, 0x4020608102008000ULL, 0x002001C404808400ULL,
+                0x180040421010521BULL, 0x40000422080228A8ULL, 0x1000184204460822ULL, 0xC000001954840400ULL,
+                0x4000000420042410ULL, 0x900020A084701080ULL, 0x00008A2024008201ULL, 0x0040080C81114100ULL
+            };
+
+            Bitboard slidingAttacks(int square, const Direction (&directions)[4], Bitboard occupied)
+            {
+                Bitboard result = 0;
+                for (Direction dir : directions)
+                {
+                    Bitboard ray = Geometry::rays().ray[dir][square];
+                    Bitboard blockers = ray & occupied;
+                    if (blockers != 0)
+                    {
+                        int blocker = geometry::towardsHigherSquares(dir) ? bits::lsb(blockers) : bits::msb(blockers);
+                        ray ^= Geometry::rays().ray[dir][blocker];
+                    }
+                    result |= ray;
+                }
+                return result;
+            }
+
+            Bitboard relevantSquares(int square, const Direction (&directions)[4])
+            {
+                Bitboard mask = 0;
+                for (Direction dir : directions)
+                {
+                    Bitboard ray = Geometry::rays().ray[dir][square];
+                    if (ray != 0)
+                    {
+                        // A piece on the last square of a ray stops nothing further
+                        int last = geometry::towardsHigherSquares(dir) ? bits::msb(ray) : bits::lsb(ray);
+                        mask |= ray & ~bits::squareMask<Bitboard>(last);
+                    }
+                }
+                return mask;
+            }
+
+            /**
+             * @brief
+             * Fills the entry and attack sets of one square.
+             * @return
+             * Number of attack sets used.
+             */
+            int buildSquare(Entry &entry, Bitboard *attacks, int square, const Direction (&directions)[4], Bitboard multiplier)
+            {
+                entry.mask = relevantSquares(square, directions);
+                entry.shift = 64 - bits::popCount(entry.mask);
+                entry.multiplier = multiplier;
+                entry.attacks = attacks;
+
+                // Every subset of the mask, by the carry-rippler trick
+                Bitboard subset = 0;
+                do
+                {
+                    attacks[entry.index(subset)] = slidingAttacks(square, directions, subset);
+                    subset = (subset - entry.mask) & entry.mask;
+                } while (subset != 0);
+                return 1 << bits::popCount(entry.mask);
+            }
+        }
+
+        Tables::Tables()
+        {
+            int used = 0;
+            for (int square = 0; square < 64; square++)
+            {
+                used += buildSquare(rook[square], rookAttacks + used, square, rookDirections, rookMultipliers[square]);
+            }
+            used = 0;
+            for (int square = 0; square < 64; square++)
+            {
+                used += buildSquare(bishop[square], bishopAttacks + used, square, bishopDirections, bishopMultipliers[square]);
+            }
+        }
+
+        const Tables tables;
+    }
+}
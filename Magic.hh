@@ -0,0 +1,74 @@
+#ifndef __MAGIC_H__
+#define __MAGIC_H__
+
+#include "Bitboard.hh"
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Rook and bishop attacks on the standard 8x8 board, each read from a
+ * table with one lookup on the occupancy. With BMI2 the table index is
+ * the PEXT of the occupancy under the piece's relevant squares; without
+ * it, a multiply by a magic number and a shift.
+ */
+namespace Student
+{
+    namespace magic
+    {
+        /** Table entries over all squares: 2^12 occupancies at most per rook square, 2^9 per bishop square. */
+        constexpr int rookEntries = 102400;
+        constexpr int bishopEntries = 5248;
+
+        struct Entry
+        {
+            /** Squares whose occupancy can stop a ray: the rays without their last square. */
+            Bitboard mask;
+            Bitboard multiplier;
+            const Bitboard *attacks;
+            int shift;
+
+            unsigned index(Bitboard occupied) const
+            {
+#if defined(__BMI2__)
+                return unsigned(_pext_u64(occupied, mask));
+#else
+                return unsigned(((occupied & mask) * multiplier) >> shift);
+#endif
+            }
+        };
+
+        /**
+         * @brief
+         * The entries and attack sets of every square. The single instance
+         * is built during static initialisation, so it must not be used
+         * from other static initialisers.
+         */
+        struct Tables
+        {
+            Tables();
+
+            Entry rook[64];
+            Entry bishop[64];
+            Bitboard rookAttacks[rookEntries];
+            Bitboard bishopAttacks[bishopEntries];
+        };
+
+        extern const Tables tables;
+
+        inline Bitboard rook(int square, Bitboard occupied)
+        {
+            const Entry &entry = tables.rook[square];
+            return entry.attacks[entry.index(occupied)];
+        }
+
+        inline Bitboard bishop(int square, Bitboard occupied)
+        {
+            const Entry &entry = tables.bishop[square];
+            return entry.attacks[entry.index(occupied)];
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef __MOVE_H__
+#define __MOVE_H__
+
+#include "Bitboard.hh"
+
+#include <cstdint>
+
+namespace Student
+{
+    /**
+     * @brief
+     * A move packed into 16 bits: origin square in the low byte and
+     * destination square in the high byte. Squares use the row-major
+     * index row * numCols + column. Whether a move captures or castles
+     * follows from the position it is played in.
+     */
+    class Move
+    {
+    public:
+        /**
+         * @brief
+         * Leaves the move uninitialised so move lists can be declared
+         * on the stack without clearing them.
+         */
+        Move() = default;
+        Move(int from, int to) : data(std::uint16_t(from | (to << 8))) {}
+
+        int from() const { return data & 0xff; }
+        int to() const { return data >> 8; }
+
+        /**
+         * @return
+         * The move packed into 16 bits.
+         */
+        std::uint16_t raw() const { return data; }
+        static Move fromRaw(std::uint16_t raw)
+        {
+            Move move;
+            move.data = raw;
+            return move;
+        }
+
+        /**
+         * @return
+         * A move that does not describe any move, with from() == to() == 0.
+         */
+        static Move none() { return fromRaw(0); }
+        bool isNone() const { return data == 0; }
+
+        bool operator==(const Move &other) const { return data == other.data; }
+        bool operator!=(const Move &other) const { return data != other.data; }
+
+    private:
+        std::uint16_t data;
+    };
+
+    /**
+     * @brief
+     * Fixed-capacity list of moves that lives on the stack.
+     */
+    template <int Capacity>
+    class BasicMoveList
+    {
+    public:
+        static constexpr int capacity = Capacity;
+
+        void add(Move move) { moves[count++] = move; }
+        void clear() { count = 0; }
+
+        /**
+         * @brief
+         * Drops every move from index size onwards.
+         */
+        void resize(int size) { count = size; }
+
+        int size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        Move &operator[](int index) { return moves[index]; }
+        const Move &operator[](int index) const { return moves[index]; }
+
+        Move *begin() { return moves; }
+        Move *end() { return moves + count; }
+        const Move *begin() const { return moves; }
+        const Move *end() const { return moves + count; }
+
+    private:
+        Move moves[Capacity];
+        int count = 0;
+    };
+
+    /**
+     * @brief
+     * Number of moves one side can have on a board of the given size.
+     * Every destination square can be reached along at most eight
+     * directions and only the first piece along a direction can move
+     * there, so one side never has more than eight moves per square.
+     */
+    constexpr int maxMoves(int squares) { return 8 * squares; }
+
+    /**
+     * @brief
+     * Move list large enough for any board ChessBoard supports.
+     */
+    using MoveList = BasicMoveList<maxMoves(BitboardTraits<WideBitboard>::capacity)>;
+}
+
+#endif
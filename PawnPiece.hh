@@ -9,13 +9,12 @@
  */
 namespace Student
 {
-    class PawnPiece : public ChessPiece
+    class PawnPiece final : public ChessPiece
     {
     public:
         PawnPiece(ChessBoard &board, Color color, int row, int column, Type type);
         bool canMoveToLocation(int toRow, int toColumn) override;
         const char *toString() override;
-        virtual Type getType() override { return Type::Pawn; };
     };
 }
 
@@ -0,0 +1,280 @@
+#include "Perft.hh"
+#include "ThreadPool.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <thread>
+
+namespace Student
+{
+    namespace
+    {
+        /**
+         * @brief
+         * Appends every legal move sequence of exactly depth plies to
+         * sequences, depth moves per sequence.
+         */
+        template <class Position>
+        void collectSequences(Position &position, int depth, std::vector<Move> &path, std::vector<Move> &sequences)
+        {
+            if (depth == 0)
+            {
+                sequences.insert(sequences.end(), path.begin(), path.end());
+                return;
+            }
+            typename Position::MoveList moves;
+            position.generateLegalMoves(position.sideToMove(), moves);
+            for (Move move : moves)
+            {
+                MoveUndo undo;
+                position.makeMove(move, undo);
+                path.push_back(move);
+                collectSequences(position, depth - 1, path, sequences);
+                path.pop_back();
+                position.unmakeMove(move, undo);
+            }
+        }
+
+        // Written by one worker only; padded so workers do not share lines
+        struct alignas(64) WorkerStats
+        {
+            std::uint64_t nodes = 0;
+            double seconds = 0;
+        };
+
+        template <class Position>
+        void parallelPerft(const Position &root, int depth, const ParallelPerftOptions &options, ParallelPerftReport &report)
+        {
+            int split = std::min(std::max(options.splitDepth, 0), depth - 1);
+            if (options.divide && depth > 0)
+            {
+                split = std::max(split, 1);
+            }
+            split = std::max(split, 0);
+
+            Position scratch = root;
+            std::vector<Move> path;
+            std::vector<Move> sequences;
+            collectSequences(scratch, split, path, sequences);
+            std::size_t tasks = split == 0 ? 1 : sequences.size() / split;
+
+            std::unique_ptr<PerftCache> cache;
+            if (options.cacheMegabytes != 0)
+            {
+                cache = std::make_unique<PerftCache>(options.cacheMegabytes);
+            }
+
+            int threads = options.threads > 0 ? options.threads : int(std::thread::hardware_concurrency());
+            ThreadPool pool(threads);
+            threads = pool.getThreadCount();
+            std::vector<Position> boards(threads, root);
+            std::vector<WorkerStats> stats(threads);
+            std::vector<std::uint64_t> taskNodes(tasks);
+
+            for (std::size_t task = 0; task < tasks; task++)
+            {
+                pool.submit([&, task](int worker) {
+                    auto start = std::chrono::steady_clock::now();
+                    Position &position = boards[worker];
+                    const Move *sequence = sequences.data() + task * split;
+                    std::vector<MoveUndo> undos(split);
+                    for (int i = 0; i < split; i++)
+                    {
+                        position.makeMove(sequence[i], undos[i]);
+                    }
+                    std::uint64_t nodes = cache ? perft(position, depth - split, *cache) : perft(position, depth - split);
+                    for (int i = split - 1; i >= 0; i--)
+                    {
+                        position.unmakeMove(sequence[i], undos[i]);
+                    }
+
+                    taskNodes[task] = nodes;
+                    stats[worker].nodes += nodes;
+                    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                    stats[worker].seconds += elapsed.count();
+                });
+            }
+            pool.wait();
+
+            if (options.divide && depth > 0)
+            {
+                typename Position::MoveList rootMoves;
+                root.generateLegalMoves(root.sideToMove(), rootMoves);
+                for (Move move : rootMoves)
+                {
+                    report.divide.emplace_back(move, 0);
+                }
+                // Tasks come in root move order, so one pass matches them up
+                std::size_t entry = 0;
+                for (std::size_t task = 0; task < tasks; task++)
+                {
+                    while (report.divide[entry].first != sequences[task * split])
+                    {
+                        entry++;
+                    }
+                    report.divide[entry].second += taskNodes[task];
+                }
+            }
+
+            report.tasks = tasks;
+            for (std::size_t task = 0; task < tasks; task++)
+            {
+                report.nodes += taskNodes[task];
+            }
+            for (const WorkerStats &worker : stats)
+            {
+                report.threadNodes.push_back(worker.nodes);
+                report.threadSeconds.push_back(worker.seconds);
+            }
+        }
+    }
+
+    PerftCache::PerftCache(std::size_t megabytes)
+    {
+        std::size_t budget = megabytes * 1024 * 1024 / sizeof(Entry);
+        std::size_t count = 1;
+        while (count * 2 <= budget)
+        {
+            count *= 2;
+        }
+        entries.reset(new Entry[count]);
+        entryMask = count - 1;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            entries[i].check.store(0, std::memory_order_relaxed);
+            entries[i].nodes.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    bool PerftCache::probe(std::uint64_t key, int depth, std::uint64_t &nodes) const
+    {
+        std::uint64_t slotKey = keyAtDepth(key, depth);
+        const Entry &entry = entries[slotKey & entryMask];
+        std::uint64_t stored = entry.nodes.load(std::memory_order_relaxed);
+        std::uint64_t check = entry.check.load(std::memory_order_relaxed);
+        if ((check ^ stored) != slotKey || stored == 0)
+        {
+            return false;
+        }
+        nodes = stored;
+        return true;
+    }
+
+    void PerftCache::store(std::uint64_t key, int depth, std::uint64_t nodes)
+    {
+        std::uint64_t slotKey = keyAtDepth(key, depth);
+        Entry &entry = entries[slotKey & entryMask];
+        entry.nodes.store(nodes, std::memory_order_relaxed);
+        entry.check.store(slotKey ^ nodes, std::memory_order_relaxed);
+    }
+
+    PerftReport runPerft(ChessBoard &board, int depth, bool divide)
+    {
+        PerftReport report;
+        auto start = std::chrono::steady_clock::now();
+
+        board.withPosition([&](auto &pos) {
+            if (!divide || depth < 1)
+            {
+                report.nodes = perft(pos, depth);
+                return;
+            }
+            typename std::decay_t<decltype(pos)>::MoveList moves;
+            pos.generateLegalMoves(pos.sideToMove(), moves);
+            for (Move move : moves)
+            {
+                MoveUndo undo;
+                pos.makeMove(move, undo);
+                std::uint64_t nodes = perft(pos, depth - 1);
+                pos.unmakeMove(move, undo);
+                report.divide.emplace_back(move, nodes);
+                report.nodes += nodes;
+            }
+        });
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        report.seconds = elapsed.count();
+        report.nodesPerSecond = report.seconds > 0 ? report.nodes / report.seconds : 0;
+        return report;
+    }
+
+    ParallelPerftReport runParallelPerft(ChessBoard &board, int depth, const ParallelPerftOptions &options)
+    {
+        ParallelPerftReport report;
+        auto start = std::chrono::steady_clock::now();
+        board.withPosition([&](const auto &pos) { parallelPerft(pos, depth, options, report); });
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        report.seconds = elapsed.count();
+        report.nodesPerSecond = report.seconds > 0 ? report.nodes / report.seconds : 0;
+        double busy = 0;
+        for (double seconds : report.threadSeconds)
+        {
+            busy += seconds;
+        }
+        report.efficiency = report.seconds > 0 ? busy / (report.threadSeconds.size() * report.seconds) : 0;
+        return report;
+    }
+
+    const std::vector<PerftCase> &perftSuite()
+    {
+        // Counts recomputed by tests/PerftReferenceTest.cc, a separate square-by-square
+        // move generator; change them only together with a rule change that it reproduces
+        static const std::vector<PerftCase> suite = {
+            {"start", 8, 8,
+             "r.b.kb.r/pppppppp/......../......../......../......../PPPPPPPP/R.B.KB.R",
+             {19, 361, 7317, 147914}},
+            {"castling", 8, 8,
+             "r...k..r/pp....pp/......../..b..B../......../......../PP....PP/R...K..R",
+             {29, 768, 20718, 544746}},
+            {"middlegame", 8, 8,
+             "r.b.k..r/pp...ppp/..p.p.../...p.b../.B.P..../....P.../PPP..PPP/R...K.BR",
+             {28, 652, 17543, 425001}},
+            {"endgame", 8, 8,
+             "....k.../..p...../......../.b...P../......../..K...../......R./........",
+             {21, 287, 5439, 72422, 1340648}},
+            {"wide", 8, 10,
+             "r.b..k.b.r/pppppppppp/........../........../........../........../PPPPPPPPPP/R.B..K.B.R",
+             {24, 576, 14380, 358367}},
+            {"small", 6, 6,
+             "r..k.r/.p..p./....../....../.P..P./R..K.R",
+             {22, 412, 7740, 135649, 2376174}},
+        };
+        return suite;
+    }
+
+    void placePieces(ChessBoard &board, const char *layout)
+    {
+        int row = 0;
+        int column = 0;
+        for (const char *c = layout; *c != '\0'; c++)
+        {
+            if (*c == '/')
+            {
+                row++;
+                column = 0;
+                continue;
+            }
+            Color color = std::isupper(static_cast<unsigned char>(*c)) ? White : Black;
+            switch (std::toupper(static_cast<unsigned char>(*c)))
+            {
+            case 'P':
+                board.createChessPiece(color, Pawn, row, column);
+                break;
+            case 'R':
+                board.createChessPiece(color, Rook, row, column);
+                break;
+            case 'B':
+                board.createChessPiece(color, Bishop, row, column);
+                break;
+            case 'K':
+                board.createChessPiece(color, King, row, column);
+                break;
+            default:
+                break;
+            }
+            column++;
+        }
+    }
+}
@@ -0,0 +1,221 @@
+#ifndef __PERFT_H__
+#define __PERFT_H__
+
+#include "ChessBoard.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Student
+{
+    /**
+     * @brief
+     * Counts the leaf nodes of the legal move tree of a position.
+     * @param position
+     * The position to expand. Restored before returning.
+     * @param depth
+     * Number of plies to expand.
+     * @return
+     * Number of move sequences of exactly depth plies.
+     */
+    template <class Position>
+    std::uint64_t perft(Position &position, int depth)
+    {
+        if (depth == 0)
+        {
+            return 1;
+        }
+        typename Position::MoveList moves;
+        position.generateLegalMoves(position.sideToMove(), moves);
+        if (depth == 1)
+        {
+            return moves.size();
+        }
+
+        std::uint64_t nodes = 0;
+        for (Move move : moves)
+        {
+            MoveUndo undo;
+            position.makeMove(move, undo);
+            nodes += perft(position, depth - 1);
+            position.unmakeMove(move, undo);
+        }
+        return nodes;
+    }
+
+    /**
+     * @brief
+     * Hash table of subtree leaf counts keyed by Zobrist key and depth,
+     * safe to share between threads without locks.
+     *
+     * The table is direct-mapped and always replaces. An entry holds the
+     * count and the key XORed with it, and a probe only accepts an entry
+     * that XORs back to the probed key, so a torn entry is never used.
+     */
+    class PerftCache
+    {
+    public:
+        /**
+         * @param megabytes
+         * Memory budget, rounded down to a power-of-two number of entries.
+         */
+        explicit PerftCache(std::size_t megabytes);
+
+        bool probe(std::uint64_t key, int depth, std::uint64_t &nodes) const;
+        void store(std::uint64_t key, int depth, std::uint64_t nodes);
+
+    private:
+        struct Entry
+        {
+            std::atomic<std::uint64_t> check;
+            std::atomic<std::uint64_t> nodes;
+        };
+
+        static std::uint64_t keyAtDepth(std::uint64_t key, int depth)
+        {
+            return key ^ (std::uint64_t(depth) * 0x9E3779B97F4A7C15ULL);
+        }
+
+        std::unique_ptr<Entry[]> entries;
+        std::uint64_t entryMask = 0;
+    };
+
+    /**
+     * @brief
+     * perft that looks up and records the counts of subtrees of depth 2
+     * and more in a cache.
+     */
+    template <class Position>
+    std::uint64_t perft(Position &position, int depth, PerftCache &cache)
+    {
+        if (depth < 2)
+        {
+            return perft(position, depth);
+        }
+        std::uint64_t nodes = 0;
+        if (cache.probe(position.hash(), depth, nodes))
+        {
+            return nodes;
+        }
+
+        typename Position::MoveList moves;
+        position.generateLegalMoves(position.sideToMove(), moves);
+        for (Move move : moves)
+        {
+            MoveUndo undo;
+            position.makeMove(move, undo);
+            nodes += perft(position, depth - 1, cache);
+            position.unmakeMove(move, undo);
+        }
+        cache.store(position.hash(), depth, nodes);
+        return nodes;
+    }
+
+    /**
+     * @brief
+     * Result of a timed perft run.
+     */
+    struct PerftReport
+    {
+        /** Leaf count below each root move, filled in divide mode only. */
+        std::vector<std::pair<Move, std::uint64_t>> divide;
+        std::uint64_t nodes = 0;
+        double seconds = 0;
+        double nodesPerSecond = 0;
+    };
+
+    /**
+     * @brief
+     * Runs a timed perft from the board's current position, with the side
+     * whose turn it is to move first.
+     * @param board
+     * A board set up with createChessPiece (and possibly some moves).
+     * @param depth
+     * Number of plies to expand.
+     * @param divide
+     * Whether to report the leaf count below every root move.
+     */
+    PerftReport runPerft(ChessBoard &board, int depth, bool divide);
+
+    /**
+     * @brief
+     * Settings of a parallel perft run.
+     */
+    struct ParallelPerftOptions
+    {
+        /** Worker threads; 0 uses every hardware thread. */
+        int threads = 0;
+        /**
+         * Plies expanded before splitting the tree into one task per move
+         * sequence. Clamped so every task has at least one ply left.
+         */
+        int splitDepth = 2;
+        /** Size of the shared perft cache; 0 disables it. */
+        std::size_t cacheMegabytes = 0;
+        bool divide = false;
+    };
+
+    /**
+     * @brief
+     * Result of a parallel perft run.
+     */
+    struct ParallelPerftReport : PerftReport
+    {
+        /** Number of tasks the tree was split into. */
+        std::size_t tasks = 0;
+        /** Leaf nodes counted by each worker. */
+        std::vector<std::uint64_t> threadNodes;
+        /** Time each worker spent running tasks. */
+        std::vector<double> threadSeconds;
+        /**
+         * Total task time over threads times wall time: the speed-up over
+         * running the same tasks on one thread, divided by the thread count.
+         */
+        double efficiency = 0;
+    };
+
+    /**
+     * @brief
+     * Runs perft from the board's current position on a work-stealing
+     * thread pool. The tree is split at options.splitDepth into tasks, and
+     * every worker expands its tasks on its own copy of the position.
+     */
+    ParallelPerftReport runParallelPerft(ChessBoard &board, int depth, const ParallelPerftOptions &options);
+
+    /**
+     * @brief
+     * A reference position with known perft results, White to move.
+     */
+    struct PerftCase
+    {
+        const char *name;
+        int numRows;
+        int numCols;
+        /**
+         * Rows from row 0 separated by '/', one character per square:
+         * P, R, B, K for White, p, r, b, k for Black, '.' for empty.
+         */
+        const char *layout;
+        /** expected[d - 1] is the perft result at depth d. */
+        std::vector<std::uint64_t> expected;
+    };
+
+    /**
+     * @return
+     * Reference positions covering castling, 8x8 and non-8x8 boards.
+     */
+    const std::vector<PerftCase> &perftSuite();
+
+    /**
+     * @brief
+     * Places the pieces of a PerftCase layout on an empty board through
+     * createChessPiece.
+     */
+    void placePieces(ChessBoard &board, const char *layout);
+}
+
+#endif
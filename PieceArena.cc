@@ -0,0 +1,51 @@
+#include "PieceArena.hh"
+
+namespace Student
+{
+    PieceArena::PieceArena(int numCols)
+        : pawns(numCols > 0 ? 2 * std::size_t(numCols) : 16), rooks(4), bishops(4), kings(2)
+    {
+    }
+
+    ChessPiece *PieceArena::create(ChessBoard &board, Color color, Type type, int row, int column)
+    {
+        switch (type)
+        {
+        case Pawn:
+            return pawns.create(board, color, row, column, type);
+        case Rook:
+            return rooks.create(board, color, row, column, type);
+        case Bishop:
+            return bishops.create(board, color, row, column, type);
+        case King:
+            return kings.create(board, color, row, column, type);
+        default:
+            return nullptr;
+        }
+    }
+
+    void PieceArena::release(ChessPiece *piece)
+    {
+        if (piece == nullptr)
+        {
+            return;
+        }
+        switch (piece->getType())
+        {
+        case Pawn:
+            pawns.release(static_cast<PawnPiece *>(piece));
+            break;
+        case Rook:
+            rooks.release(static_cast<RookPiece *>(piece));
+            break;
+        case Bishop:
+            bishops.release(static_cast<BishopPiece *>(piece));
+            break;
+        case King:
+            kings.release(static_cast<KingPiece *>(piece));
+            break;
+        default:
+            break;
+        }
+    }
+}
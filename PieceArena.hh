@@ -0,0 +1,113 @@
+#ifndef __PIECEARENA_H__
+#define __PIECEARENA_H__
+
+#include "BishopPiece.hh"
+#include "KingPiece.hh"
+#include "PawnPiece.hh"
+#include "RookPiece.hh"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace Student
+{
+    /**
+     * @brief
+     * Object pool for one piece class. Slots are carved from chunks that
+     * never move, so a piece keeps its address for its whole life, and a
+     * released slot goes on a free list to be reused by the next create.
+     */
+    template <class Piece>
+    class PiecePool
+    {
+    public:
+        /**
+         * @param chunkSize
+         * Number of slots allocated whenever the free list runs dry.
+         */
+        explicit PiecePool(std::size_t chunkSize) : chunkSize(chunkSize) {}
+
+        PiecePool(const PiecePool &) = delete;
+        PiecePool &operator=(const PiecePool &) = delete;
+
+        /**
+         * @brief
+         * Constructs a piece in a free slot.
+         */
+        template <class... Args>
+        Piece *create(Args &&...args)
+        {
+            if (freeList == nullptr)
+            {
+                grow();
+            }
+            Slot *slot = freeList;
+            freeList = slot->next;
+            return new (slot->storage) Piece(std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief
+         * Destroys a piece made by this pool and puts its slot on the
+         * free list. The memory is only returned when the pool is destroyed.
+         */
+        void release(Piece *piece)
+        {
+            piece->~Piece();
+            Slot *slot = reinterpret_cast<Slot *>(piece);
+            slot->next = freeList;
+            freeList = slot;
+        }
+
+    private:
+        union Slot
+        {
+            Slot *next;
+            alignas(Piece) unsigned char storage[sizeof(Piece)];
+        };
+
+        void grow()
+        {
+            chunks.push_back(std::make_unique<Slot[]>(chunkSize));
+            Slot *chunk = chunks.back().get();
+            for (std::size_t i = 0; i < chunkSize; i++)
+            {
+                chunk[i].next = freeList;
+                freeList = &chunk[i];
+            }
+        }
+
+        std::size_t chunkSize;
+        std::vector<std::unique_ptr<Slot[]>> chunks;
+        Slot *freeList = nullptr;
+    };
+
+    /**
+     * @brief
+     * The piece pools of one board, one per piece class. Pieces must all
+     * be released before the arena is destroyed.
+     */
+    class PieceArena
+    {
+    public:
+        /**
+         * @param numCols
+         * Board width, used to size the pawn chunks to a full set of pawns.
+         */
+        explicit PieceArena(int numCols);
+
+        ChessPiece *create(ChessBoard &board, Color color, Type type, int row, int column);
+        void release(ChessPiece *piece);
+
+    private:
+        PiecePool<PawnPiece> pawns;
+        PiecePool<RookPiece> rooks;
+        PiecePool<BishopPiece> bishops;
+        PiecePool<KingPiece> kings;
+    };
+}
+
+#endif
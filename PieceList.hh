@@ -0,0 +1,80 @@
+#ifndef __PIECELIST_H__
+#define __PIECELIST_H__
+
+#include "ChessPiece.hh"
+
+#include <cassert>
+#include <vector>
+
+namespace Student
+{
+    /**
+     * @brief
+     * The pieces of a board grouped by colour and type. Each piece stores
+     * its index in its list, so adding and removing are O(1): a removed
+     * piece's slot is filled by the last piece of the same list. The order
+     * within a list is therefore unspecified.
+     *
+     * No rules query reads these lists. Attacks, move generation and
+     * evaluation run on the position's per-colour and per-type bitboards,
+     * which hold the same grouping as one mask per list and are walked
+     * without touching the pieces at all. The lists are for callers that
+     * need the ChessPiece objects themselves, through
+     * ChessBoard::getPieces, without scanning every square.
+     */
+    class PieceList
+    {
+    public:
+        void add(ChessPiece *piece)
+        {
+            std::vector<ChessPiece *> &list = lists[piece->color][piece->type];
+            piece->listSlot = int(list.size());
+            list.push_back(piece);
+        }
+
+        /**
+         * @brief
+         * Removes a listed piece. Removing a piece that is not in this
+         * list is a logic error.
+         */
+        void remove(ChessPiece *piece)
+        {
+            std::vector<ChessPiece *> &list = lists[piece->color][piece->type];
+            assert(piece->listSlot >= 0 && piece->listSlot < int(list.size()) && list[piece->listSlot] == piece);
+            ChessPiece *last = list.back();
+            list[piece->listSlot] = last;
+            last->listSlot = piece->listSlot;
+            list.pop_back();
+            piece->listSlot = -1;
+        }
+
+        /**
+         * @brief
+         * Empties every list without touching the pieces, which may
+         * already have been released.
+         */
+        void clear()
+        {
+            for (auto &byType : lists)
+            {
+                for (std::vector<ChessPiece *> &list : byType)
+                {
+                    list.clear();
+                }
+            }
+        }
+
+        /**
+         * @return
+         * The pieces of one colour and type, in no particular order.
+         */
+        const std::vector<ChessPiece *> &of(Color color, Type type) const { return lists[color][type]; }
+
+        int count(Color color, Type type) const { return int(lists[color][type].size()); }
+
+    private:
+        std::vector<ChessPiece *> lists[2][4];
+    };
+}
+
+#endif
@@ -0,0 +1,237 @@
+#ifndef __PIECERULES_H__
+#define __PIECERULES_H__
+
+#include "ChessBoard.hh"
+#include "Instrumentation.hh"
+
+#include <cstdlib>
+
+namespace Student
+{
+    /**
+     * @brief
+     * Movement rule of one piece type, chosen at compile time so the
+     * compiler can inline and specialise it. The piece classes forward
+     * their canMoveToLocation here, so each rule exists once.
+     */
+    template <Type T>
+    struct PieceRules;
+
+    namespace rules
+    {
+        /**
+         * @return
+         * True if the square lies on the board. Checked before any square
+         * index is formed, so off-board targets never reach the tables.
+         */
+        inline bool isOnBoard(const ChessBoard &board, int row, int column)
+        {
+            return row >= 0 && row < board.getNumRows() && column >= 0 && column < board.getNumCols();
+        }
+
+        /**
+         * @return
+         * True if every square strictly between the two squares, which
+         * must share a row, column or diagonal, is empty. The squares come
+         * from the between table of the board's geometry.
+         */
+        inline bool isPathClear(ChessBoard &board, int row, int column, int toRow, int toColumn)
+        {
+            return board.withPosition([&](const auto &pos) {
+                const auto &geo = pos.geometry();
+                auto path = attacks::between(geo, geo.square(row, column), geo.square(toRow, toColumn));
+                if constexpr (instrumentation::enabled)
+                {
+                    instrumentation::count(instrumentation::CountSquaresScanned, std::uint64_t(bits::popCount(path)));
+                }
+                return !bits::any(path & pos.occupancy());
+            });
+        }
+
+        /**
+         * @return
+         * True if the square is empty or holds a piece of the other colour.
+         */
+        inline bool canLandOn(ChessBoard &board, Color color, int toRow, int toColumn)
+        {
+            ChessPiece *targetPiece = board.getPiece(toRow, toColumn);
+            return targetPiece == nullptr || targetPiece->getColor() != color;
+        }
+    }
+
+    template <>
+    struct PieceRules<Pawn>
+    {
+        static bool canMoveToLocation(ChessPiece &piece, int toRow, int toColumn)
+        {
+            instrumentation::count(instrumentation::CountPawnRules);
+            Color color = piece.getColor();
+            return piece.board.withPosition([&](const auto &pos) {
+                const auto &geo = pos.geometry();
+                if (!geo.contains(toRow, toColumn))
+                {
+                    return false;
+                }
+                int from = geo.square(piece.getRow(), piece.getColumn());
+                int to = geo.square(toRow, toColumn);
+                const auto &steps = geo.steps();
+
+                // One-square movement
+                if (bits::test(steps.pawnPush[color][from], to))
+                {
+                    return pos.isEmpty(to);
+                }
+
+                // Two-square movement, from the start row only
+                if (bits::test(steps.pawnDoublePush[color][from], to))
+                {
+                    return !bits::any((steps.pawnPush[color][from] | steps.pawnDoublePush[color][from]) & pos.occupancy());
+                }
+
+                // Diagonal movement needs an enemy piece on the target square
+                if (bits::test(steps.pawnCapture[color][from], to))
+                {
+                    return !pos.isEmpty(to) && pos.colorAt(to) != color;
+                }
+                return false;
+            });
+        }
+    };
+
+    template <>
+    struct PieceRules<Rook>
+    {
+        static bool canMoveToLocation(ChessPiece &piece, int toRow, int toColumn)
+        {
+            instrumentation::count(instrumentation::CountRookRules);
+            int row = piece.getRow();
+            int column = piece.getColumn();
+            if (!rules::isOnBoard(piece.board, toRow, toColumn))
+            {
+                return false;
+            }
+            if (row != toRow && column != toColumn)
+            {
+                return false;
+            }
+            return rules::isPathClear(piece.board, row, column, toRow, toColumn) &&
+                   rules::canLandOn(piece.board, piece.getColor(), toRow, toColumn);
+        }
+    };
+
+    template <>
+    struct PieceRules<Bishop>
+    {
+        static bool canMoveToLocation(ChessPiece &piece, int toRow, int toColumn)
+        {
+            instrumentation::count(instrumentation::CountBishopRules);
+            int row = piece.getRow();
+            int column = piece.getColumn();
+            if (!rules::isOnBoard(piece.board, toRow, toColumn))
+            {
+                return false;
+            }
+            if (std::abs(row - toRow) != std::abs(column - toColumn))
+            {
+                return false;
+            }
+            return rules::isPathClear(piece.board, row, column, toRow, toColumn) &&
+                   rules::canLandOn(piece.board, piece.getColor(), toRow, toColumn);
+        }
+    };
+
+    template <>
+    struct PieceRules<King>
+    {
+        static bool canMoveToLocation(ChessPiece &piece, int toRow, int toColumn)
+        {
+            instrumentation::count(instrumentation::CountKingRules);
+            bool isStep = piece.board.withPosition([&](const auto &pos) {
+                const auto &geo = pos.geometry();
+                return geo.contains(toRow, toColumn) &&
+                       bits::test(geo.steps().king[geo.square(piece.getRow(), piece.getColumn())], geo.square(toRow, toColumn));
+            });
+            if (isStep)
+            {
+                return rules::canLandOn(piece.board, piece.getColor(), toRow, toColumn);
+            }
+
+            // Castling logic
+            return toRow == piece.getRow() && std::abs(toColumn - piece.getColumn()) == 2 && canCastle(piece, toColumn);
+        }
+
+        static bool canCastle(ChessPiece &piece, int toColumn)
+        {
+            ChessBoard &board = piece.board;
+            int row = piece.getRow();
+            int column = piece.getColumn();
+
+            // Castling is only allowed if the King has not moved
+            if (piece.getHasMoved())
+            {
+                return false;
+            }
+
+            // Determine the Rook's corner based on the castling direction
+            int rookColumn = board.withPosition([&](const auto &pos) {
+                const auto &geo = pos.geometry();
+                return geo.columnOf(geo.steps().castlingRook[geo.square(row, column)][toColumn > column]);
+            });
+            ChessPiece *rook = board.getPiece(row, rookColumn);
+
+            // Validate the Rook's position and state
+            if (rook == nullptr || rook->getType() != Type::Rook || rook->getColor() != piece.getColor() || rook->getHasMoved())
+            {
+                return false;
+            }
+
+            // Ensure the path between the King and Rook is clear
+            if (!rules::isPathClear(board, row, column, row, rookColumn))
+            {
+                return false;
+            }
+
+            // Ensure the King does not move through or into a square under attack
+            int step = (toColumn > column) ? 1 : -1;
+            for (int col = column; col != toColumn + step; col += step)
+            {
+                if (board.isSquareUnderAttack(row, col, piece.getColor()))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    };
+
+    /**
+     * @brief
+     * Checks a piece's movement rule, switching on its type so the
+     * built-in rules are called directly. Pieces of other classes (custom
+     * pieces derived from ChessPiece) go through the virtual
+     * canMoveToLocation.
+     */
+    inline bool canMoveToLocation(ChessPiece &piece, int toRow, int toColumn)
+    {
+        if (!piece.hasStandardRules())
+        {
+            return piece.canMoveToLocation(toRow, toColumn);
+        }
+        switch (piece.getType())
+        {
+        case Pawn:
+            return PieceRules<Pawn>::canMoveToLocation(piece, toRow, toColumn);
+        case Rook:
+            return PieceRules<Rook>::canMoveToLocation(piece, toRow, toColumn);
+        case Bishop:
+            return PieceRules<Bishop>::canMoveToLocation(piece, toRow, toColumn);
+        case King:
+            return PieceRules<King>::canMoveToLocation(piece, toRow, toColumn);
+        default:
+            return false;
+        }
+    }
+}
+
+#endif
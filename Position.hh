@@ -0,0 +1,909 @@
+#ifndef __POSITION_H__
+#define __POSITION_H__
+
+#include "Attacks.hh"
+#include "Evaluation.hh"
+#include "Instrumentation.hh"
+#include "Move.hh"
+#include "Zobrist.hh"
+
+#include <array>
+#include <cstdint>
+
+namespace Student
+{
+    /**
+     * @brief
+     * What BasicPosition::makeMove needs to remember for unmakeMove.
+     */
+    struct MoveUndo
+    {
+        /** Piece code of the captured piece, 0 if nothing was captured. */
+        std::uint8_t captured;
+        bool capturedHadMoved;
+        bool moverHadMoved;
+        bool castled;
+        bool rookHadMoved;
+    };
+
+    /**
+     * @brief
+     * Outcome of checking a move against a position, naming the first
+     * rule the move fails.
+     */
+    enum MoveStatus
+    {
+        MoveOk,
+        /** A square index is outside the board. */
+        MoveOffBoard,
+        MoveFromEmptySquare,
+        /** The piece on the origin square belongs to the side not to move. */
+        MoveWrongTurn,
+        /** The piece cannot move that way. */
+        MoveBreaksRules,
+        MoveLeavesKingInCheck,
+    };
+
+    /**
+     * @brief
+     * Check and pin state of one side's king, computed once per position
+     * by BasicPosition::checkInfo so that most legality tests need no
+     * attack computation at all.
+     */
+    template <class BB>
+    struct BasicCheckInfo
+    {
+        /** A king has at most eight rays to be pinned along. */
+        static constexpr int maxPins = 8;
+
+        /** Square of the side's king, or -1 if it has no king or several. */
+        int king;
+        /** Enemy pieces giving check. */
+        BB checkers;
+        /** The checkers and the squares between sliding checkers and the king. */
+        BB blockSquares;
+        /**
+         * Squares next to the king on the far side from a sliding checker.
+         * They are attacked once the king steps there, although the attack
+         * maps, which see the king as a blocker, do not show it.
+         */
+        BB xrays;
+        /** Pieces of the side pinned to the king. */
+        BB pinned;
+        int pinCount;
+        int pinnedSquare[maxPins];
+        /** Squares a pinned piece may still move to: up to and including the pinner. */
+        BB pinRay[maxPins];
+    };
+
+    /**
+     * @brief
+     * Bitboard representation of the pieces on a board.
+     * Keeps one square set per colour and per piece type, plus a
+     * square-indexed array of piece codes for O(1) lookups by square.
+     * Per-colour attack maps and the Zobrist key are updated incrementally
+     * as pieces are put and removed, so attack and check queries are
+     * lookups and the key is always current.
+     * Geo is a BoardGeometry or StaticGeometry describing the board
+     * dimensions.
+     */
+    template <class Geo>
+    class BasicPosition
+    {
+    public:
+        using Geometry = Geo;
+        using Bitboard = typename Geo::Bitboard;
+        using MoveList = BasicMoveList<maxMoves(Geo::maxSquares)>;
+        using CheckInfo = BasicCheckInfo<Bitboard>;
+
+        static constexpr int colorCount = 2;
+        static constexpr int typeCount = 4;
+
+        /** Largest piece code; 0 stands for an empty square. */
+        static constexpr std::uint8_t maxPieceCode = colorCount * typeCount;
+        /** Set in a code passed to assign for a piece that has not moved. */
+        static constexpr std::uint8_t unmovedFlag = 0x80;
+
+        static std::uint8_t encode(Color color, Type type)
+        {
+            return std::uint8_t(1 + color * typeCount + type);
+        }
+        static Color decodeColor(std::uint8_t code) { return Color((code - 1) / typeCount); }
+        static Type decodeType(std::uint8_t code) { return Type((code - 1) % typeCount); }
+
+        explicit BasicPosition(const Geo &geometry)
+            : BasicPosition(geometry, &evaluation::pieceSquareTable(geometry.rows(), geometry.cols()))
+        {
+        }
+
+        const Geo &geometry() const { return geo; }
+
+        /**
+         * @brief
+         * Places a piece on an empty square.
+         * @param hasMoved
+         * Whether the piece counts as having moved already (castling rights).
+         */
+        void putPiece(Color color, Type type, int square, bool hasMoved)
+        {
+            // The new piece cuts the rays of sliders passing through the square
+            updateRaysThrough(square, -1);
+            Bitboard mask = bits::squareMask<Bitboard>(square);
+            byColor[color] |= mask;
+            byType[type] |= mask;
+            occupied |= mask;
+            if (!hasMoved)
+                unmoved |= mask;
+            board[square] = encode(color, type);
+            key ^= zobrist::keys.piece[board[square]][square];
+            psqScore += psq->value[board[square]][square];
+            countAttacks(color, pieceAttacks(square), +1);
+            if (!hasMoved && (type == King || type == Rook))
+                refreshCastlingRights();
+        }
+
+        /**
+         * @brief
+         * Replaces the whole position in one pass: the masks, codes and key
+         * are filled square by square and the attack maps built once
+         * afterwards, instead of updating the slider rays piece by piece as
+         * putPiece does.
+         * @param codes
+         * One entry per square: 0 for an empty square, otherwise a piece
+         * code from encode, with unmovedFlag set if the piece has not moved.
+         * Codes must be valid.
+         * @param toMove
+         * The side to move.
+         */
+        void assign(const std::uint8_t *codes, Color toMove)
+        {
+            *this = BasicPosition(geo, psq);
+            int squares = geo.squares();
+            for (int square = 0; square < squares; square++)
+            {
+                std::uint8_t code = codes[square] & ~unmovedFlag;
+                if (code == 0)
+                    continue;
+                Bitboard mask = bits::squareMask<Bitboard>(square);
+                byColor[decodeColor(code)] |= mask;
+                byType[decodeType(code)] |= mask;
+                occupied |= mask;
+                if (codes[square] & unmovedFlag)
+                    unmoved |= mask;
+                board[square] = code;
+                key ^= zobrist::keys.piece[code][square];
+                psqScore += psq->value[code][square];
+            }
+            // Every ray already stops at its final blocker, so each piece is counted once
+            Bitboard remaining = occupied;
+            while (bits::any(remaining))
+            {
+                int square = bits::popLsb(remaining);
+                countAttacks(colorAt(square), pieceAttacks(square), +1);
+            }
+            refreshCastlingRights();
+            setSideToMove(toMove);
+        }
+
+        /**
+         * @return
+         * The piece code on a square, 0 if it is empty.
+         */
+        std::uint8_t codeAt(int square) const { return board[square]; }
+
+        /**
+         * @brief
+         * Removes the piece on a square, if any.
+         */
+        void removePiece(int square)
+        {
+            if (isEmpty(square))
+                return;
+            countAttacks(colorAt(square), pieceAttacks(square), -1);
+            bool castlingPiece = !hasMoved(square) && (typeAt(square) == King || typeAt(square) == Rook);
+            key ^= zobrist::keys.piece[board[square]][square];
+            psqScore -= psq->value[board[square]][square];
+            Bitboard mask = ~bits::squareMask<Bitboard>(square);
+            byColor[colorAt(square)] &= mask;
+            byType[typeAt(square)] &= mask;
+            occupied &= mask;
+            unmoved &= mask;
+            board[square] = 0;
+            // Sliders whose rays stopped on the square now reach past it
+            updateRaysThrough(square, +1);
+            if (castlingPiece)
+                refreshCastlingRights();
+        }
+
+        /**
+         * @brief
+         * Moves a piece to an empty square.
+         * @param hasMoved
+         * Whether the piece counts as having moved afterwards.
+         */
+        void relocatePiece(int from, int to, bool hasMoved = true)
+        {
+            Color color = colorAt(from);
+            Type type = typeAt(from);
+            removePiece(from);
+            putPiece(color, type, to, hasMoved);
+        }
+
+        /**
+         * @brief
+         * Plays a move, capturing whatever stands on its destination and
+         * bringing the rook along when a king castles. The move is not
+         * validated. Passes the turn to the other side.
+         * @param undo
+         * Filled with what unmakeMove needs to take the move back.
+         */
+        void makeMove(Move move, MoveUndo &undo)
+        {
+            int from = move.from();
+            int to = move.to();
+            undo.captured = board[to];
+            undo.capturedHadMoved = hasMoved(to);
+            undo.moverHadMoved = hasMoved(from);
+            undo.castled = isCastling(from, to);
+
+            removePiece(to);
+            relocatePiece(from, to);
+            if (undo.castled)
+            {
+                int rookFrom = castlingRookFrom(from, to);
+                undo.rookHadMoved = hasMoved(rookFrom);
+                relocatePiece(rookFrom, castlingRookTo(from, to));
+            }
+            side = opponent(side);
+            key ^= zobrist::keys.side;
+        }
+
+        /**
+         * @brief
+         * Takes back a move played with makeMove.
+         */
+        void unmakeMove(Move move, const MoveUndo &undo)
+        {
+            int from = move.from();
+            int to = move.to();
+            side = opponent(side);
+            key ^= zobrist::keys.side;
+            if (undo.castled)
+            {
+                relocatePiece(castlingRookTo(from, to), castlingRookFrom(from, to), undo.rookHadMoved);
+            }
+            relocatePiece(to, from, undo.moverHadMoved);
+            if (undo.captured != 0)
+            {
+                putPiece(decodeColor(undo.captured), decodeType(undo.captured), to, undo.capturedHadMoved);
+            }
+        }
+
+        /**
+         * @return
+         * The colour whose turn it is.
+         */
+        Color sideToMove() const { return side; }
+        void setSideToMove(Color color)
+        {
+            if (color != side)
+                key ^= zobrist::keys.side;
+            side = color;
+        }
+
+        /**
+         * @return
+         * Zobrist key of the pieces, castling rights and side to move.
+         */
+        std::uint64_t hash() const { return key; }
+
+        /**
+         * @return
+         * The Zobrist key the position will have after the move, without
+         * making it. Used to prefetch hash table entries.
+         */
+        std::uint64_t hashAfter(Move move) const
+        {
+            int from = move.from();
+            int to = move.to();
+            std::uint8_t piece = board[from];
+            std::uint64_t after = key ^ zobrist::keys.side;
+            after ^= zobrist::keys.piece[piece][from] ^ zobrist::keys.piece[piece][to];
+            if (!isEmpty(to))
+                after ^= zobrist::keys.piece[board[to]][to];
+
+            Bitboard touched = bits::squareMask<Bitboard>(from) | bits::squareMask<Bitboard>(to);
+            if (isCastling(from, to))
+            {
+                int rookFrom = castlingRookFrom(from, to);
+                std::uint8_t rook = board[rookFrom];
+                after ^= zobrist::keys.piece[rook][rookFrom] ^ zobrist::keys.piece[rook][castlingRookTo(from, to)];
+                touched |= bits::squareMask<Bitboard>(rookFrom);
+            }
+            // Pieces that have never moved stay put, so only the touched ones can lose rights
+            if (bits::any(unmoved & touched))
+                after ^= zobrist::keys.castling[castling] ^ zobrist::keys.castling[castlingRightsFor(unmoved & ~touched)];
+            return after;
+        }
+
+        /**
+         * @return
+         * CastlingRight bits for every unmoved king with an unmoved rook of
+         * its colour in a corner of its row.
+         */
+        int castlingRights() const { return castling; }
+
+        /**
+         * @return
+         * The unmoved kings and rooks that the castling rights depend on.
+         * Whether any other piece has moved changes no rule.
+         */
+        Bitboard castlingPieces() const
+        {
+            Bitboard result{};
+            for (Color color : {White, Black})
+            {
+                Bitboard kings = pieces(color, King) & unmoved;
+                Bitboard rooks = pieces(color, Rook) & unmoved;
+                while (bits::any(kings))
+                {
+                    int king = bits::popLsb(kings);
+                    for (int side = 0; side < 2; side++)
+                    {
+                        int rook = geo.steps().castlingRook[king][side];
+                        if (bits::test(rooks, rook))
+                            result |= bits::squareMask<Bitboard>(king) | bits::squareMask<Bitboard>(rook);
+                    }
+                }
+            }
+            return result;
+        }
+
+        /**
+         * @return
+         * Material and piece-square value of every piece on the board from
+         * White's point of view, kept up to date by putPiece and removePiece.
+         */
+        int pieceSquareScore() const { return psqScore; }
+
+        bool isEmpty(int square) const { return board[square] == 0; }
+        Color colorAt(int square) const { return decodeColor(board[square]); }
+        Type typeAt(int square) const { return decodeType(board[square]); }
+        bool hasMoved(int square) const { return !bits::test(unmoved, square); }
+
+        Bitboard occupancy() const { return occupied; }
+        Bitboard pieces(Color color) const { return byColor[color]; }
+        Bitboard pieces(Type type) const { return byType[type]; }
+        Bitboard pieces(Color color, Type type) const { return byColor[color] & byType[type]; }
+
+        /**
+         * @return
+         * Every piece of either colour that attacks the square, given the
+         * occupancy occ.
+         */
+        Bitboard attackersTo(int square, Bitboard occ) const
+        {
+            return (attacks::pawnFrom(geo, White, square) & pieces(Black, Pawn)) |
+                   (attacks::pawnFrom(geo, Black, square) & pieces(White, Pawn)) |
+                   (attacks::kingFrom(geo, square) & byType[King]) |
+                   (attacks::rookFrom(geo, square, occ) & byType[Rook]) |
+                   (attacks::bishopFrom(geo, square, occ) & byType[Bishop]);
+        }
+
+        /**
+         * @return
+         * True if a piece of colour by attacks the square.
+         */
+        bool isAttackedBy(int square, Color by) const
+        {
+            return bits::test(attacked[by], square);
+        }
+
+        /**
+         * @return
+         * Every square attacked by at least one piece of colour by.
+         */
+        Bitboard attackedSquares(Color by) const { return attacked[by]; }
+
+        /**
+         * @return
+         * Number of pieces of colour by attacking the square.
+         */
+        int attackerCount(int square, Color by) const { return attackCount[by][square]; }
+
+        /**
+         * @return
+         * True if any king of the given colour is attacked.
+         */
+        bool isInCheck(Color color) const
+        {
+            return bits::any(pieces(color, King) & attacked[opponent(color)]);
+        }
+
+        /**
+         * @return
+         * The squares the piece on from may move to by its movement rules,
+         * except castling. The mover's king safety is not considered.
+         */
+        Bitboard moveTargets(int from) const
+        {
+            Color us = colorAt(from);
+            switch (typeAt(from))
+            {
+            case Pawn:
+            {
+                const auto &steps = geo.steps();
+                Bitboard targets = steps.pawnPush[us][from] & ~occupied;
+                // Pawns may advance two squares from their starting row
+                if (bits::any(targets))
+                    targets |= steps.pawnDoublePush[us][from] & ~occupied;
+                return targets | (steps.pawnCapture[us][from] & byColor[opponent(us)]);
+            }
+            case Rook:
+                return attacks::rookFrom(geo, from, occupied) & ~byColor[us];
+            case Bishop:
+                return attacks::bishopFrom(geo, from, occupied) & ~byColor[us];
+            case King:
+                return attacks::kingFrom(geo, from) & ~byColor[us];
+            default:
+                return Bitboard{};
+            }
+        }
+
+        /**
+         * @brief
+         * Checks the movement rules of the piece on from, ignoring turn and
+         * whether the move leaves the mover's own king in check.
+         */
+        bool isPseudoLegal(int from, int to) const
+        {
+            if (from == to || isEmpty(from))
+                return false;
+            return bits::test(moveTargets(from), to) || canCastle(from, to);
+        }
+
+        /**
+         * @brief
+         * Checks the movement rules of the piece on from and that the move
+         * does not leave any king of the mover's colour in check.
+         */
+        bool isLegal(int from, int to) const
+        {
+            return isPseudoLegal(from, to) && keepsKingSafe(from, to, checkInfo(colorAt(from)));
+        }
+
+        /**
+         * @brief
+         * isLegal for a position whose checkInfo for the mover is already
+         * known, e.g. when testing many moves of one position.
+         */
+        bool isLegal(int from, int to, const CheckInfo &info) const
+        {
+            return isPseudoLegal(from, to) && keepsKingSafe(from, to, info);
+        }
+
+        /**
+         * @brief
+         * Checks a move for the side to move, including turn and bounds.
+         * @param info
+         * checkInfo(sideToMove()).
+         */
+        MoveStatus classifyMove(Move move, const CheckInfo &info) const
+        {
+            int from = move.from();
+            int to = move.to();
+            if (from >= geo.squares() || to >= geo.squares())
+                return MoveOffBoard;
+            if (isEmpty(from))
+                return MoveFromEmptySquare;
+            if (colorAt(from) != side)
+                return MoveWrongTurn;
+            if (!isPseudoLegal(from, to))
+                return MoveBreaksRules;
+            if (!keepsKingSafe(from, to, info))
+                return MoveLeavesKingInCheck;
+            return MoveOk;
+        }
+
+        /**
+         * @brief
+         * Finds the checkers of a side's king and the pieces pinned to it.
+         */
+        CheckInfo checkInfo(Color us) const
+        {
+            CheckInfo info;
+            info.king = -1;
+            info.checkers = info.blockSquares = info.xrays = info.pinned = Bitboard{};
+            info.pinCount = 0;
+            Bitboard kings = pieces(us, King);
+            if (bits::popCount(kings) != 1)
+                return info;
+
+            Color them = opponent(us);
+            info.king = bits::lsb(kings);
+            info.checkers = attackersTo(info.king, occupied) & byColor[them];
+            info.blockSquares = info.checkers;
+
+            // Enemy sliders that would attack the king if none of our pieces were in the way
+            Bitboard snipers = (attacks::rookFrom(geo, info.king, byColor[them]) & pieces(them, Rook)) |
+                               (attacks::bishopFrom(geo, info.king, byColor[them]) & pieces(them, Bishop));
+            while (bits::any(snipers))
+            {
+                int sniper = bits::popLsb(snipers);
+                Bitboard sniperMask = bits::squareMask<Bitboard>(sniper);
+                Bitboard between = attacks::between(geo, info.king, sniper);
+                Bitboard blockers = between & occupied;
+                if (!bits::any(blockers))
+                {
+                    info.blockSquares |= between;
+                    info.xrays |= attacks::step(geo, kings, geo.directionTowards(sniper, info.king));
+                }
+                else if (bits::popCount(blockers) == 1 && bits::any(blockers & byColor[us]))
+                {
+                    info.pinned |= blockers;
+                    info.pinnedSquare[info.pinCount] = bits::lsb(blockers);
+                    info.pinRay[info.pinCount++] = between | sniperMask;
+                }
+            }
+            return info;
+        }
+
+        /**
+         * @return
+         * The squares the piece on from may legally move to, except by
+         * castling, given the checkInfo of its side. The side must have
+         * exactly one king.
+         */
+        Bitboard legalTargets(int from, const CheckInfo &info) const
+        {
+            Bitboard targets = moveTargets(from);
+            if (from == info.king)
+                return targets & ~(attacked[opponent(colorAt(from))] | info.xrays);
+            if (bits::any(info.checkers))
+            {
+                // Only the king can answer a double check
+                if (bits::popCount(info.checkers) > 1)
+                    return Bitboard{};
+                targets &= info.blockSquares;
+            }
+            if (bits::test(info.pinned, from))
+                targets &= pinRayOf(from, info);
+            return targets;
+        }
+
+        /**
+         * @brief
+         * Adds every move of the given colour that follows the movement
+         * rules, including moves that leave its own king in check.
+         */
+        template <class List>
+        void generatePseudoLegalMoves(Color us, List &moves) const
+        {
+            Bitboard own = byColor[us];
+            while (bits::any(own))
+            {
+                int from = bits::popLsb(own);
+                Bitboard targets = moveTargets(from);
+                while (bits::any(targets))
+                {
+                    moves.add(Move(from, bits::popLsb(targets)));
+                }
+                if (typeAt(from) == King)
+                    addCastlingMoves(from, moves);
+            }
+        }
+
+        /**
+         * @brief
+         * Adds every legal move of the given colour.
+         */
+        template <class List>
+        void generateLegalMoves(Color us, List &moves) const
+        {
+            CheckInfo info = checkInfo(us);
+            if (info.king >= 0)
+            {
+                Bitboard own = byColor[us];
+                while (bits::any(own))
+                {
+                    int from = bits::popLsb(own);
+                    Bitboard targets = legalTargets(from, info);
+                    while (bits::any(targets))
+                    {
+                        moves.add(Move(from, bits::popLsb(targets)));
+                    }
+                    if (from == info.king)
+                        addCastlingMoves(from, moves);
+                }
+                return;
+            }
+
+            // Without exactly one king, test every move on its own
+            int first = moves.size();
+            generatePseudoLegalMoves(us, moves);
+            int kept = first;
+            for (int i = first; i < moves.size(); i++)
+            {
+                if (keepsKingSafe(moves[i].from(), moves[i].to()))
+                    moves[kept++] = moves[i];
+            }
+            moves.resize(kept);
+        }
+
+        /**
+         * @brief
+         * Adds every legal capture of the given colour.
+         */
+        template <class List>
+        void generateLegalCaptures(Color us, List &moves) const
+        {
+            CheckInfo info = checkInfo(us);
+            Bitboard own = byColor[us];
+            Bitboard enemies = byColor[opponent(us)];
+            while (bits::any(own))
+            {
+                int from = bits::popLsb(own);
+                if (info.king >= 0)
+                {
+                    Bitboard targets = legalTargets(from, info) & enemies;
+                    while (bits::any(targets))
+                    {
+                        moves.add(Move(from, bits::popLsb(targets)));
+                    }
+                    continue;
+                }
+                Bitboard targets = moveTargets(from) & enemies;
+                while (bits::any(targets))
+                {
+                    int to = bits::popLsb(targets);
+                    if (keepsKingSafe(from, to))
+                        moves.add(Move(from, to));
+                }
+            }
+        }
+
+        /**
+         * @return
+         * True if the move is a king moving two columns along its row.
+         */
+        bool isCastling(int from, int to) const
+        {
+            if (isEmpty(from) || typeAt(from) != King || geo.rowOf(from) != geo.rowOf(to))
+                return false;
+            int colDiff = geo.columnOf(to) - geo.columnOf(from);
+            return colDiff == 2 || colDiff == -2;
+        }
+
+        /**
+         * @return
+         * Starting square of the rook that takes part in a castling move.
+         */
+        int castlingRookFrom(int from, int to) const
+        {
+            return geo.steps().castlingRook[from][to > from];
+        }
+
+        /**
+         * @return
+         * Destination square of the rook that takes part in a castling move.
+         */
+        int castlingRookTo(int from, int to) const
+        {
+            return to > from ? to - 1 : to + 1;
+        }
+
+    private:
+        BasicPosition(const Geo &geometry, const PieceSquareTable *table) : geo(geometry), psq(table) {}
+
+        /**
+         * @return
+         * The squares attacked by the piece on a square.
+         */
+        Bitboard pieceAttacks(int square) const
+        {
+            switch (typeAt(square))
+            {
+            case Pawn:
+                return attacks::pawnFrom(geo, colorAt(square), square);
+            case Rook:
+                return attacks::rookFrom(geo, square, occupied);
+            case Bishop:
+                return attacks::bishopFrom(geo, square, occupied);
+            case King:
+                return attacks::kingFrom(geo, square);
+            default:
+                return Bitboard{};
+            }
+        }
+
+        /**
+         * @brief
+         * Adds delta to the attacker count of every square in the set.
+         */
+        void countAttacks(Color color, Bitboard squares, int delta)
+        {
+            if constexpr (instrumentation::enabled)
+            {
+                instrumentation::count(instrumentation::CountAttackMapUpdates, std::uint64_t(bits::popCount(squares)));
+            }
+            while (bits::any(squares))
+            {
+                int square = bits::popLsb(squares);
+                std::uint8_t &count = attackCount[color][square];
+                if (delta > 0)
+                {
+                    if (count++ == 0)
+                        attacked[color] |= bits::squareMask<Bitboard>(square);
+                }
+                else if (--count == 0)
+                {
+                    attacked[color] &= ~bits::squareMask<Bitboard>(square);
+                }
+            }
+        }
+
+        /**
+         * @brief
+         * Adjusts the attack maps for the sliders whose rays pass through an
+         * empty square that is about to be (or has just been) occupied.
+         * Only the part of each ray beyond the square is recounted.
+         */
+        void updateRaysThrough(int square, int delta)
+        {
+            Bitboard sliders = (attacks::rookFrom(geo, square, occupied) & byType[Rook]) |
+                               (attacks::bishopFrom(geo, square, occupied) & byType[Bishop]);
+            while (bits::any(sliders))
+            {
+                int from = bits::popLsb(sliders);
+                Direction dir = geo.directionTowards(from, square);
+                countAttacks(colorAt(from), attacks::ray(geo, square, dir, occupied), delta);
+            }
+        }
+
+        /**
+         * @return
+         * True if no king of the mover's colour is attacked once the piece
+         * on from has moved to to.
+         */
+        bool keepsKingSafe(int from, int to) const
+        {
+            Color us = colorAt(from);
+            Bitboard fromMask = bits::squareMask<Bitboard>(from);
+            Bitboard toMask = bits::squareMask<Bitboard>(to);
+            Bitboard occ = (occupied & ~fromMask) | toMask;
+            Bitboard enemies = byColor[opponent(us)] & ~toMask;
+            Bitboard kings = pieces(us, King);
+            if (typeAt(from) == King)
+                kings = (kings & ~fromMask) | toMask;
+
+            while (bits::any(kings))
+            {
+                if (bits::any(attackersTo(bits::popLsb(kings), occ) & enemies))
+                    return false;
+            }
+            return true;
+        }
+
+        /**
+         * @brief
+         * keepsKingSafe for a pseudo-legal move, using the mover's
+         * checkInfo. Apart from king moves this is a few mask tests.
+         */
+        bool keepsKingSafe(int from, int to, const CheckInfo &info) const
+        {
+            if (info.king < 0)
+                return keepsKingSafe(from, to);
+            if (from == info.king)
+            {
+                // canCastle has already checked every square of the king's path
+                if (isCastling(from, to))
+                    return true;
+                return !isAttackedBy(to, opponent(colorAt(from))) && !bits::test(info.xrays, to);
+            }
+            if (bits::any(info.checkers))
+            {
+                if (bits::popCount(info.checkers) > 1 || !bits::test(info.blockSquares, to))
+                    return false;
+            }
+            return !bits::test(info.pinned, from) || bits::test(pinRayOf(from, info), to);
+        }
+
+        static Bitboard pinRayOf(int square, const CheckInfo &info)
+        {
+            for (int i = 0; i < info.pinCount; i++)
+            {
+                if (info.pinnedSquare[i] == square)
+                    return info.pinRay[i];
+            }
+            return Bitboard{};
+        }
+
+        template <class List>
+        void addCastlingMoves(int from, List &moves) const
+        {
+            int row = geo.rowOf(from);
+            int column = geo.columnOf(from);
+            if (hasMoved(from))
+                return;
+            if (column + 2 < geo.cols() && canCastle(from, geo.square(row, column + 2)))
+                moves.add(Move(from, geo.square(row, column + 2)));
+            if (column - 2 >= 0 && canCastle(from, geo.square(row, column - 2)))
+                moves.add(Move(from, geo.square(row, column - 2)));
+        }
+
+        /**
+         * @brief
+         * Castling requires an unmoved king and an unmoved rook of the same
+         * colour in the corner of the king's row, no pieces between them,
+         * and no attacked square on the king's path.
+         */
+        bool canCastle(int from, int to) const
+        {
+            if (!isCastling(from, to) || hasMoved(from) || !isEmpty(to))
+                return false;
+
+            Color us = colorAt(from);
+            int rookSquare = castlingRookFrom(from, to);
+            if (isEmpty(rookSquare) || typeAt(rookSquare) != Rook || colorAt(rookSquare) != us || hasMoved(rookSquare))
+                return false;
+
+            if (bits::any(attacks::between(geo, from, rookSquare) & occupied))
+                return false;
+            Bitboard path = attacks::between(geo, from, to) | bits::squareMask<Bitboard>(from) | bits::squareMask<Bitboard>(to);
+            return !bits::any(path & attacked[opponent(us)]);
+        }
+
+        /**
+         * @return
+         * The castling rights if exactly the pieces in stillUnmoved had not moved.
+         */
+        int castlingRightsFor(Bitboard stillUnmoved) const
+        {
+            int rights = 0;
+            for (Color color : {White, Black})
+            {
+                Bitboard kings = pieces(color, King) & stillUnmoved;
+                Bitboard rooks = pieces(color, Rook) & stillUnmoved;
+                while (bits::any(kings))
+                {
+                    int king = bits::popLsb(kings);
+                    if (bits::test(rooks, geo.steps().castlingRook[king][0]))
+                        rights |= (color == White) ? WhiteLeft : BlackLeft;
+                    if (bits::test(rooks, geo.steps().castlingRook[king][1]))
+                        rights |= (color == White) ? WhiteRight : BlackRight;
+                }
+            }
+            return rights;
+        }
+
+        void refreshCastlingRights()
+        {
+            int rights = castlingRightsFor(unmoved);
+            key ^= zobrist::keys.castling[castling] ^ zobrist::keys.castling[rights];
+            castling = rights;
+        }
+
+        Geo geo;
+        Bitboard byColor[colorCount]{};
+        Bitboard byType[typeCount]{};
+        Bitboard occupied{};
+        Bitboard unmoved{};
+        Color side = White;
+        int castling = 0;
+        std::uint64_t key = 0;
+        /** Piece-square table of this board size, shared by every position of it. */
+        const PieceSquareTable *psq;
+        int psqScore = 0;
+        Bitboard attacked[colorCount]{};
+        std::array<std::uint8_t, Geo::maxSquares> attackCount[colorCount]{};
+        /** Piece code per square, 0 for an empty square. */
+        std::array<std::uint8_t, Geo::maxSquares> board{};
+    };
+
+    using NarrowPosition = BasicPosition<BoardGeometry<Bitboard>>;
+    using WidePosition = BasicPosition<BoardGeometry<WideBitboard>>;
+    /** The standard 8x8 board, with its geometry fixed at compile time. */
+    using StandardPosition = BasicPosition<StaticGeometry<8, 8>>;
+}
+
+#endif
@@ -0,0 +1,185 @@
+#include "PositionCodec.hh"
+
+#include <array>
+#include <cctype>
+
+namespace
+{
+    using Student::StandardPosition;
+
+    /** Castling rights in the order of a FEN castling field. */
+    const struct
+    {
+        char letter;
+        Student::CastlingRight right;
+    } castlingLetters[] = {
+        {'K', Student::WhiteRight},
+        {'Q', Student::WhiteLeft},
+        {'k', Student::BlackRight},
+        {'q', Student::BlackLeft},
+    };
+
+    std::uint8_t codeOfLetter(char letter)
+    {
+        for (std::uint8_t code = 1; code <= StandardPosition::maxPieceCode; code++)
+        {
+            if (Student::codec::pieceLetters[code] == letter)
+            {
+                return code;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief
+     * Marks the king and corner rook behind a castling right as unmoved.
+     * @return
+     * False if the side has no king with a rook of its colour in that corner.
+     */
+    bool grantCastling(std::uint8_t *codes, int numRows, int numCols, Student::CastlingRight right)
+    {
+        Color color = (right == Student::WhiteLeft || right == Student::WhiteRight) ? White : Black;
+        std::uint8_t king = StandardPosition::encode(color, King);
+        std::uint8_t rook = StandardPosition::encode(color, Rook);
+        int rookColumn = (right == Student::WhiteLeft || right == Student::BlackLeft) ? 0 : numCols - 1;
+        for (int square = 0; square < numRows * numCols; square++)
+        {
+            if ((codes[square] & ~StandardPosition::unmovedFlag) != king)
+            {
+                continue;
+            }
+            int rookSquare = (square / numCols) * numCols + rookColumn;
+            if ((codes[rookSquare] & ~StandardPosition::unmovedFlag) != rook)
+            {
+                return false;
+            }
+            codes[square] |= StandardPosition::unmovedFlag;
+            codes[rookSquare] |= StandardPosition::unmovedFlag;
+            return true;
+        }
+        return false;
+    }
+}
+
+namespace Student
+{
+    bool packBoard(ChessBoard &board, PackedPosition &packed)
+    {
+        return board.withPosition([&](const auto &pos) { return packPosition(pos, packed); });
+    }
+
+    bool loadPacked(ChessBoard &board, const PackedPosition &packed)
+    {
+        if (packed.rows != board.getNumRows() || packed.cols != board.getNumCols())
+        {
+            return false;
+        }
+        std::uint8_t codes[PackedPosition::maxSquares];
+        if (!codec::unpackCodes(packed, codes))
+        {
+            return false;
+        }
+        return board.loadPosition(codes, packed.sideToMove());
+    }
+
+    std::string toFen(const ChessBoard &board)
+    {
+        std::string fen(fenBound(board.getNumRows(), board.getNumCols()), '\0');
+        char *end = board.withPosition([&](const auto &pos) { return writeFen(pos, &fen[0]); });
+        fen.resize(std::size_t(end - fen.data()));
+        return fen;
+    }
+
+    bool loadFen(ChessBoard &board, const char *fen)
+    {
+        int numRows = board.getNumRows();
+        int numCols = board.getNumCols();
+        std::array<std::uint8_t, BitboardTraits<WideBitboard>::capacity> codes{};
+        const char *p = fen;
+
+        for (int row = 0; row < numRows; row++)
+        {
+            if (row > 0 && *p++ != '/')
+            {
+                return false;
+            }
+            int column = 0;
+            while (column < numCols)
+            {
+                if (std::isdigit(static_cast<unsigned char>(*p)))
+                {
+                    int empty = 0;
+                    while (std::isdigit(static_cast<unsigned char>(*p)))
+                    {
+                        empty = empty * 10 + (*p++ - '0');
+                    }
+                    if (empty == 0 || column + empty > numCols)
+                    {
+                        return false;
+                    }
+                    column += empty;
+                    continue;
+                }
+                std::uint8_t code = codeOfLetter(*p++);
+                if (code == 0)
+                {
+                    return false;
+                }
+                // Kings and rooks only stay unmoved if a castling right needs them
+                Type type = StandardPosition::decodeType(code);
+                if (type != King && type != Rook)
+                {
+                    code |= StandardPosition::unmovedFlag;
+                }
+                codes[row * numCols + column++] = code;
+            }
+        }
+
+        if (*p++ != ' ')
+        {
+            return false;
+        }
+        Color toMove;
+        switch (*p++)
+        {
+        case 'w':
+            toMove = White;
+            break;
+        case 'b':
+            toMove = Black;
+            break;
+        default:
+            return false;
+        }
+
+        if (*p++ != ' ')
+        {
+            return false;
+        }
+        if (*p == '-')
+        {
+            p++;
+        }
+        else
+        {
+            for (const auto &entry : castlingLetters)
+            {
+                if (*p == entry.letter)
+                {
+                    if (!grantCastling(codes.data(), numRows, numCols, entry.right))
+                    {
+                        return false;
+                    }
+                    p++;
+                }
+            }
+        }
+        if (*p != '\0' && *p != ' ')
+        {
+            return false;
+        }
+
+        return board.loadPosition(codes.data(), toMove);
+    }
+}
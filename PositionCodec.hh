@@ -0,0 +1,287 @@
+#ifndef __POSITIONCODEC_H__
+#define __POSITIONCODEC_H__
+
+#include "ChessBoard.hh"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace Student
+{
+    /**
+     * @brief
+     * Fixed-size binary encoding of a position of at most 64 squares and
+     * 32 pieces, 32 bytes whatever the board. Records can be stored in
+     * flat arrays or files and read in place: every field is a plain byte
+     * or a little-endian 64-bit word.
+     *
+     * The pieces are listed in square order, one nibble each, low nibble
+     * first: bits 0-2 hold color * 4 + type and bit 3 is set for an
+     * unmoved king or rook that a castling right depends on. No other
+     * piece carries it, so positions that play the same pack to the same
+     * bytes. Nibbles past the last piece are 0.
+     */
+    struct PackedPosition
+    {
+        static constexpr int maxSquares = 64;
+        static constexpr int maxPieces = 32;
+
+        /** Flag bit for Black to move; the castling rights sit above it. */
+        static constexpr std::uint8_t blackToMove = 1;
+        static constexpr int castlingShift = 1;
+
+        /** One bit per occupied square, square = row * cols + column. */
+        std::uint64_t occupancy;
+        std::uint8_t pieces[maxPieces / 2];
+        std::uint8_t rows;
+        std::uint8_t cols;
+        /**
+         * blackToMove, and the CastlingRight bits shifted by castlingShift.
+         * The rights follow from the unmoved pieces; they are stored so
+         * records can be filtered without decoding them.
+         */
+        std::uint8_t flags;
+        std::uint8_t reserved[5];
+
+        Color sideToMove() const { return (flags & blackToMove) ? Black : White; }
+        int castlingRights() const { return flags >> castlingShift; }
+    };
+    static_assert(sizeof(PackedPosition) == 32, "PackedPosition must stay 32 bytes");
+    static_assert(std::is_trivially_copyable<PackedPosition>::value, "PackedPosition is copied as raw bytes");
+
+    namespace codec
+    {
+        constexpr std::uint8_t nibbleUnmoved = 0x8;
+
+        /** FEN letter of each piece code, indexed by code; ' ' for 0. */
+        constexpr char pieceLetters[] = " prbkPRBK";
+
+        inline bool isLittleEndian()
+        {
+            const std::uint16_t probe = 1;
+            std::uint8_t first;
+            std::memcpy(&first, &probe, 1);
+            return first == 1;
+        }
+
+        /** Converts between host order and the little-endian order of the format. */
+        inline std::uint64_t littleEndian(std::uint64_t value)
+        {
+            if (isLittleEndian())
+                return value;
+            std::uint64_t swapped = 0;
+            for (int i = 0; i < 8; i++)
+                swapped = (swapped << 8) | ((value >> (8 * i)) & 0xff);
+            return swapped;
+        }
+
+        /**
+         * @brief
+         * Expands a packed record into the per-square codes taken by
+         * BasicPosition::assign and ChessBoard::loadPosition.
+         * @param codes
+         * Receives rows * cols entries.
+         * @return
+         * False if the record is malformed.
+         */
+        inline bool unpackCodes(const PackedPosition &packed, std::uint8_t *codes)
+        {
+            int squares = packed.rows * packed.cols;
+            if (packed.rows == 0 || packed.cols == 0 || squares > PackedPosition::maxSquares)
+                return false;
+            std::uint64_t occupancy = littleEndian(packed.occupancy);
+            if (squares < 64 && (occupancy >> squares) != 0)
+                return false;
+            if (bits::popCount(occupancy) > PackedPosition::maxPieces)
+                return false;
+
+            std::memset(codes, 0, std::size_t(squares));
+            int index = 0;
+            while (occupancy != 0)
+            {
+                int square = bits::popLsb(occupancy);
+                std::uint8_t nibble = (packed.pieces[index / 2] >> (4 * (index % 2))) & 0xf;
+                index++;
+                codes[square] = std::uint8_t(1 + (nibble & 0x7));
+                if (nibble & nibbleUnmoved)
+                    codes[square] |= StandardPosition::unmovedFlag;
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @brief
+     * Packs a position, reading its occupancy mask directly.
+     * @return
+     * False if the board has more than 64 squares or 32 pieces.
+     */
+    template <class Position>
+    bool packPosition(const Position &position, PackedPosition &packed)
+    {
+        using Bitboard = typename Position::Bitboard;
+        if constexpr (!std::is_same<Bitboard, std::uint64_t>::value)
+        {
+            return false;
+        }
+        else
+        {
+            const auto &geo = position.geometry();
+            Bitboard occupancy = position.occupancy();
+            if (bits::popCount(occupancy) > PackedPosition::maxPieces)
+                return false;
+
+            std::memset(&packed, 0, sizeof(packed));
+            packed.occupancy = codec::littleEndian(occupancy);
+            packed.rows = std::uint8_t(geo.rows());
+            packed.cols = std::uint8_t(geo.cols());
+            packed.flags = std::uint8_t((position.sideToMove() == Black ? PackedPosition::blackToMove : 0) |
+                                        (position.castlingRights() << PackedPosition::castlingShift));
+            Bitboard castlingPieces = position.castlingPieces();
+            int index = 0;
+            while (bits::any(occupancy))
+            {
+                int square = bits::popLsb(occupancy);
+                std::uint8_t nibble = std::uint8_t(position.codeAt(square) - 1);
+                if (bits::test(castlingPieces, square))
+                    nibble |= codec::nibbleUnmoved;
+                packed.pieces[index / 2] |= std::uint8_t(nibble << (4 * (index % 2)));
+                index++;
+            }
+            return true;
+        }
+    }
+
+    /**
+     * @brief
+     * Loads a packed record into a position of the same dimensions.
+     * @return
+     * False, leaving the position unchanged, if the dimensions differ or
+     * the record is malformed.
+     */
+    template <class Position>
+    bool unpackPosition(const PackedPosition &packed, Position &position)
+    {
+        const auto &geo = position.geometry();
+        if (packed.rows != geo.rows() || packed.cols != geo.cols())
+            return false;
+        std::uint8_t codes[PackedPosition::maxSquares];
+        if (!codec::unpackCodes(packed, codes))
+            return false;
+        position.assign(codes, packed.sideToMove());
+        return true;
+    }
+
+    /**
+     * @brief
+     * Packs the position on a board.
+     * @return
+     * False if the board has more than 64 squares or 32 pieces.
+     */
+    bool packBoard(ChessBoard &board, PackedPosition &packed);
+
+    /**
+     * @brief
+     * Replaces the pieces and side to move of a board with a packed
+     * record, through ChessBoard::loadPosition. Clears the undo history.
+     * @return
+     * False, leaving the board unchanged, if the dimensions differ or the
+     * record is malformed.
+     */
+    bool loadPacked(ChessBoard &board, const PackedPosition &packed);
+
+    /**
+     * @return
+     * An upper bound on the length of the FEN-style text of a position
+     * with the given dimensions, without a terminating null.
+     */
+    constexpr std::size_t fenBound(int rows, int cols)
+    {
+        // Each square takes at most one character, plus the separators,
+        // the side to move and four castling letters
+        return std::size_t(rows * cols + (rows - 1) + 3 + 4);
+    }
+
+    /**
+     * @brief
+     * Writes the FEN-style text of toFen into a buffer of at least
+     * fenBound characters, without a terminating null.
+     * @return
+     * One past the last character written.
+     */
+    template <class Position>
+    char *writeFen(const Position &position, char *out)
+    {
+        const auto &geo = position.geometry();
+        int numRows = geo.rows();
+        int numCols = geo.cols();
+        for (int row = 0; row < numRows; row++)
+        {
+            if (row > 0)
+                *out++ = '/';
+            int empty = 0;
+            for (int column = 0; column < numCols; column++)
+            {
+                std::uint8_t code = position.codeAt(row * numCols + column);
+                if (code == 0)
+                {
+                    empty++;
+                    continue;
+                }
+                if (empty >= 10)
+                    *out++ = char('0' + empty / 10);
+                if (empty > 0)
+                    *out++ = char('0' + empty % 10);
+                empty = 0;
+                *out++ = codec::pieceLetters[code];
+            }
+            if (empty >= 10)
+                *out++ = char('0' + empty / 10);
+            if (empty > 0)
+                *out++ = char('0' + empty % 10);
+        }
+        *out++ = ' ';
+        *out++ = (position.sideToMove() == White) ? 'w' : 'b';
+        *out++ = ' ';
+        int rights = position.castlingRights();
+        if (rights == 0)
+            *out++ = '-';
+        if (rights & WhiteRight)
+            *out++ = 'K';
+        if (rights & WhiteLeft)
+            *out++ = 'Q';
+        if (rights & BlackRight)
+            *out++ = 'k';
+        if (rights & BlackLeft)
+            *out++ = 'q';
+        return out;
+    }
+
+    /**
+     * @brief
+     * Writes a board in a FEN-style text form for any board size:
+     * the rows from row 0 down, separated by '/', with P R B K for White,
+     * p r b k for Black and a number for each run of empty squares; then
+     * 'w' or 'b' for the side to move and the castling rights, K and Q
+     * (k and q for Black) for castling towards the last and the first
+     * column, or '-' for none.
+     */
+    std::string toFen(const ChessBoard &board);
+
+    /**
+     * @brief
+     * Loads a board from the text form written by toFen. Any fields after
+     * the castling rights, such as the move counters of standard FEN, are
+     * ignored. Kings and rooks count as moved unless a castling right
+     * needs them; every other piece counts as unmoved.
+     * @return
+     * False, leaving the board unchanged, if the text does not describe a
+     * position of the board's dimensions or a castling right has no king
+     * and corner rook to back it.
+     */
+    bool loadFen(ChessBoard &board, const char *fen);
+}
+
+#endif
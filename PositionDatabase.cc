@@ -0,0 +1,418 @@
+#include "PositionDatabase.hh"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Student
+{
+    namespace
+    {
+        const char fileMagic[8] = {'C', 'H', 'E', 'S', 'S', 'P', 'D', 'B'};
+        constexpr std::uint32_t fileVersion = 2;
+        constexpr std::uint64_t minIndexSlots = 16;
+        /** Times a lookup remaps a file that keeps growing under it before giving up. */
+        constexpr int maxRemaps = 8;
+
+        /** Smallest power of two index with at most half its slots used by capacity records. */
+        std::uint64_t indexSlotsFor(std::uint64_t capacity)
+        {
+            std::uint64_t slots = minIndexSlots;
+            while (slots < 2 * capacity)
+            {
+                slots *= 2;
+            }
+            return slots;
+        }
+
+        struct FileHeader
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t recordSize;
+            std::uint64_t recordCount;
+            std::uint64_t recordCapacity;
+            std::uint64_t indexSlots;
+            /** Incremented by every growth, before the old index is overwritten. */
+            std::uint64_t generation;
+            std::uint8_t reserved[16];
+        };
+        static_assert(sizeof(FileHeader) == 64, "the records start on a cache line");
+
+        struct IndexSlot
+        {
+            std::uint64_t key;
+            /** Record number from 1, 0 for an empty slot. Written last. */
+            std::uint64_t record;
+        };
+
+        std::size_t fileBytes(std::uint64_t recordCapacity, std::uint64_t indexSlots)
+        {
+            return sizeof(FileHeader) + recordCapacity * sizeof(PositionRecord) + indexSlots * sizeof(IndexSlot);
+        }
+
+        // The file is laid out as the header, recordCapacity records, then the index
+        FileHeader *header(unsigned char *base) { return reinterpret_cast<FileHeader *>(base); }
+        PositionRecord *recordArray(unsigned char *base)
+        {
+            return reinterpret_cast<PositionRecord *>(base + sizeof(FileHeader));
+        }
+        IndexSlot *indexArray(unsigned char *base, std::uint64_t recordCapacity)
+        {
+            return reinterpret_cast<IndexSlot *>(base + sizeof(FileHeader) + recordCapacity * sizeof(PositionRecord));
+        }
+    }
+
+    std::uint64_t packedKey(const PackedPosition &packed)
+    {
+        std::uint64_t key = zobrist::keys.castling[packed.castlingRights() & 15];
+        if (packed.sideToMove() == Black)
+        {
+            key ^= zobrist::keys.side;
+        }
+        std::uint64_t occupancy = codec::littleEndian(packed.occupancy);
+        for (int index = 0; occupancy != 0; index++)
+        {
+            int square = bits::popLsb(occupancy);
+            int nibble = (packed.pieces[index / 2] >> (4 * (index % 2))) & 0x7;
+            key ^= zobrist::keys.piece[1 + nibble][square];
+        }
+        return key;
+    }
+
+    PositionDatabase::~PositionDatabase()
+    {
+        close();
+    }
+
+    bool PositionDatabase::create(const std::string &path, std::size_t capacity)
+    {
+        close();
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            return false;
+        }
+        writable = true;
+        std::uint64_t records = capacity > 0 ? capacity : 1;
+        std::uint64_t slots = indexSlotsFor(records);
+        std::size_t bytes = fileBytes(records, slots);
+        // The extended file reads as zeros, which is an empty index
+        if (::ftruncate(fd, off_t(bytes)) != 0 || !map(bytes))
+        {
+            close();
+            return false;
+        }
+        FileHeader *h = header(base);
+        std::memcpy(h->magic, fileMagic, sizeof(fileMagic));
+        h->version = fileVersion;
+        h->recordSize = sizeof(PositionRecord);
+        h->recordCount = 0;
+        h->recordCapacity = records;
+        h->indexSlots = slots;
+        h->generation = 0;
+        recordCapacity = records;
+        indexSlots = slots;
+        generation = 0;
+        return true;
+    }
+
+    bool PositionDatabase::open(const std::string &path, bool writable)
+    {
+        close();
+        fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+        this->writable = writable;
+        if (!attach())
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void PositionDatabase::close()
+    {
+        unmap();
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+        fd = -1;
+        writable = false;
+        recordCapacity = 0;
+        indexSlots = 0;
+        generation = 0;
+    }
+
+    std::size_t PositionDatabase::size() const
+    {
+        if (!isOpen() || !isCurrent())
+        {
+            return 0;
+        }
+        // Records added past the capacity of this mapping are not visible through it
+        std::uint64_t count = __atomic_load_n(&header(base)->recordCount, __ATOMIC_ACQUIRE);
+        return std::size_t(count < recordCapacity ? count : recordCapacity);
+    }
+
+    const PositionRecord *PositionDatabase::records() const
+    {
+        return isOpen() && isCurrent() ? recordArray(base) : nullptr;
+    }
+
+    const PositionRecord *PositionDatabase::find(std::uint64_t key) const
+    {
+        return lookup(nullptr, key);
+    }
+
+    const PositionRecord *PositionDatabase::find(const PackedPosition &position) const
+    {
+        return lookup(&position, packedKey(position));
+    }
+
+    const PositionRecord *PositionDatabase::find(const PackedPosition &position, std::uint64_t key) const
+    {
+        return lookup(&position, key);
+    }
+
+    const PositionRecord *PositionDatabase::lookup(const PackedPosition *position, std::uint64_t key) const
+    {
+        if (!isOpen())
+        {
+            return nullptr;
+        }
+        const FileHeader *h = header(base);
+        for (int remaps = 0; remaps <= maxRemaps; remaps++)
+        {
+            // Seqlock read: probe, then check that no growth rewrote the index meanwhile
+            std::uint64_t seen = __atomic_load_n(&h->generation, __ATOMIC_ACQUIRE);
+            if (seen == generation)
+            {
+                std::uint64_t slot;
+                std::uint64_t record = probe(position, key, slot);
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+                if (__atomic_load_n(&h->generation, __ATOMIC_RELAXED) == seen)
+                {
+                    return record != 0 ? &recordArray(base)[record - 1] : nullptr;
+                }
+            }
+            if (!remap())
+            {
+                return nullptr;
+            }
+            h = header(base);
+        }
+        return nullptr;
+    }
+
+    bool PositionDatabase::add(const PackedPosition &position, GameResult result, Move bestMove)
+    {
+        return add(position, packedKey(position), result, bestMove);
+    }
+
+    bool PositionDatabase::add(const PackedPosition &position, std::uint64_t key, GameResult result, Move bestMove)
+    {
+        if (!isOpen() || !writable)
+        {
+            return false;
+        }
+        std::uint64_t slot;
+        std::uint64_t record = probe(&position, key, slot);
+        if (record == 0)
+        {
+            FileHeader *h = header(base);
+            // Keep the index at most three quarters full
+            if (h->recordCount == recordCapacity || 4 * (h->recordCount + 1) > 3 * indexSlots)
+            {
+                std::uint64_t capacity = 2 * recordCapacity;
+                if (!grow(capacity, indexSlotsFor(capacity)))
+                {
+                    return false;
+                }
+                h = header(base);
+                probe(&position, key, slot);
+            }
+            record = h->recordCount + 1;
+            PositionRecord &entry = recordArray(base)[record - 1];
+            std::memset(&entry, 0, sizeof(entry));
+            entry.position = position;
+            entry.key = key;
+            IndexSlot &target = indexArray(base, recordCapacity)[slot];
+            target.key = key;
+            // Readers only follow the slot once the record and key are written
+            __atomic_store_n(&target.record, record, __ATOMIC_RELEASE);
+            __atomic_store_n(&h->recordCount, record, __ATOMIC_RELEASE);
+        }
+
+        PositionRecord &entry = recordArray(base)[record - 1];
+        entry.occurrences++;
+        switch (result)
+        {
+        case WhiteWin:
+            entry.whiteWins++;
+            break;
+        case BlackWin:
+            entry.blackWins++;
+            break;
+        case Draw:
+            entry.draws++;
+            break;
+        default:
+            break;
+        }
+        if (!bestMove.isNone())
+        {
+            entry.bestMove = bestMove.raw();
+        }
+        return true;
+    }
+
+    bool PositionDatabase::sync()
+    {
+        return isOpen() && ::msync(base, mappedBytes, MS_SYNC) == 0;
+    }
+
+    std::uint64_t PositionDatabase::probe(const PackedPosition *position, std::uint64_t key, std::uint64_t &slot) const
+    {
+        const IndexSlot *index = indexArray(base, recordCapacity);
+        const PositionRecord *records = recordArray(base);
+        std::uint64_t count = __atomic_load_n(&header(base)->recordCount, __ATOMIC_ACQUIRE);
+        std::uint64_t mask = indexSlots - 1;
+        slot = key & mask;
+        // Bounded, so an index being rewritten by a growth cannot trap the probe
+        for (std::uint64_t probes = 0; probes < indexSlots; probes++, slot = (slot + 1) & mask)
+        {
+            std::uint64_t record = __atomic_load_n(&index[slot].record, __ATOMIC_ACQUIRE);
+            if (record == 0)
+            {
+                return 0;
+            }
+            // Only a growth in progress leaves numbers past the records of this mapping
+            if (record > count || record > recordCapacity)
+            {
+                return 0;
+            }
+            if (index[slot].key == key &&
+                (position == nullptr || std::memcmp(&records[record - 1].position, position, sizeof(*position)) == 0))
+            {
+                return record;
+            }
+        }
+        return 0;
+    }
+
+    bool PositionDatabase::grow(std::uint64_t newCapacity, std::uint64_t newSlots)
+    {
+        std::size_t bytes = fileBytes(newCapacity, newSlots);
+        std::size_t oldBytes = mappedBytes;
+        unmap();
+        if (::ftruncate(fd, off_t(bytes)) != 0 || !map(bytes))
+        {
+            // Go back to the old layout so the database stays usable
+            if (::ftruncate(fd, off_t(oldBytes)) != 0 || !map(oldBytes))
+            {
+                close();
+            }
+            return false;
+        }
+
+        FileHeader *h = header(base);
+        h->recordCapacity = newCapacity;
+        h->indexSlots = newSlots;
+        recordCapacity = newCapacity;
+        indexSlots = newSlots;
+        // Readers of the old layout notice the new generation before any of its index is overwritten
+        generation = h->generation + 1;
+        __atomic_store_n(&h->generation, generation, __ATOMIC_RELEASE);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        // The old index lies among the new record slots and, in small files, under the new index
+        IndexSlot *index = indexArray(base, recordCapacity);
+        std::memset(index, 0, indexSlots * sizeof(IndexSlot));
+        const PositionRecord *records = recordArray(base);
+        std::uint64_t mask = indexSlots - 1;
+        for (std::uint64_t record = 1; record <= h->recordCount; record++)
+        {
+            std::uint64_t key = records[record - 1].key;
+            std::uint64_t slot = key & mask;
+            while (index[slot].record != 0)
+            {
+                slot = (slot + 1) & mask;
+            }
+            index[slot].key = key;
+            index[slot].record = record;
+        }
+        return true;
+    }
+
+    bool PositionDatabase::attach() const
+    {
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || std::size_t(info.st_size) < sizeof(FileHeader) || !map(std::size_t(info.st_size)))
+        {
+            return false;
+        }
+        const FileHeader *h = header(base);
+        std::uint64_t layoutCapacity = h->recordCapacity;
+        std::uint64_t layoutSlots = h->indexSlots;
+        if (std::memcmp(h->magic, fileMagic, sizeof(fileMagic)) != 0 || h->version != fileVersion ||
+            h->recordSize != sizeof(PositionRecord) || h->recordCount > layoutCapacity ||
+            (layoutSlots & (layoutSlots - 1)) != 0 || layoutSlots < minIndexSlots ||
+            fileBytes(layoutCapacity, layoutSlots) > mappedBytes)
+        {
+            unmap();
+            return false;
+        }
+        generation = __atomic_load_n(&h->generation, __ATOMIC_ACQUIRE);
+        recordCapacity = layoutCapacity;
+        indexSlots = layoutSlots;
+        return true;
+    }
+
+    bool PositionDatabase::remap() const
+    {
+        // A growth extends the file before it publishes the new layout, so retry until both agree
+        for (int attempt = 0; attempt <= maxRemaps; attempt++)
+        {
+            unmap();
+            if (attach())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool PositionDatabase::isCurrent() const
+    {
+        return __atomic_load_n(&header(base)->generation, __ATOMIC_ACQUIRE) == generation || remap();
+    }
+
+    bool PositionDatabase::map(std::size_t bytes) const
+    {
+        int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+        void *mapping = ::mmap(nullptr, bytes, protection, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            return false;
+        }
+        base = static_cast<unsigned char *>(mapping);
+        mappedBytes = bytes;
+        return true;
+    }
+
+    void PositionDatabase::unmap() const
+    {
+        if (base != nullptr)
+        {
+            ::munmap(base, mappedBytes);
+        }
+        base = nullptr;
+        mappedBytes = 0;
+    }
+}
@@ -0,0 +1,228 @@
+#ifndef __POSITIONDATABASE_H__
+#define __POSITIONDATABASE_H__
+
+#include "PositionCodec.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Student
+{
+    /**
+     * @brief
+     * Outcome of a game a stored position occurred in.
+     */
+    enum GameResult
+    {
+        ResultUnknown,
+        WhiteWin,
+        BlackWin,
+        Draw,
+    };
+
+    /**
+     * @brief
+     * A position in a PositionDatabase and what is known about it,
+     * read in place from the mapped file. 64 bytes, one cache line.
+     */
+    struct PositionRecord
+    {
+        PackedPosition position;
+        /** Zobrist key of the position, as ChessBoard::getHash returns it. */
+        std::uint64_t key;
+        /** Number of times the position was added. */
+        std::uint32_t occurrences;
+        std::uint32_t whiteWins;
+        std::uint32_t blackWins;
+        std::uint32_t draws;
+        /** Move::raw() of the last best move added, 0 if none. */
+        std::uint16_t bestMove;
+        std::uint8_t reserved[6];
+
+        Move getBestMove() const { return Move::fromRaw(bestMove); }
+    };
+    static_assert(sizeof(PositionRecord) == 64, "PositionRecord must stay 64 bytes");
+
+    /**
+     * @return
+     * The Zobrist key of a packed position, computed from the record
+     * without decoding it. Equal to the hash of the position it packs.
+     */
+    std::uint64_t packedKey(const PackedPosition &packed);
+
+    /**
+     * @brief
+     * Append-only store of packed positions in a memory-mapped file.
+     *
+     * The file holds a header, the records in the order they were added,
+     * and an open-addressed hash index of (key, record number) slots with
+     * linear probing. Lookups probe the mapped index and compare records
+     * in place, so nothing is deserialised and several processes opening
+     * the same file share its pages through the page cache.
+     *
+     * Records never move. When the records or the index fill up, the file
+     * is extended and only the index, which follows the records, is
+     * rebuilt. A single process may write at a time; readers in other
+     * processes see new records once their index slot is published. Every
+     * growth increments a generation number in the header before it
+     * rewrites the old index, and lookups check it before and after
+     * probing, remapping the file when it has grown.
+     *
+     * Because lookups may remap the file, one PositionDatabase object must
+     * not be used by several threads at once; open one per thread instead.
+     */
+    class PositionDatabase
+    {
+    public:
+        PositionDatabase() = default;
+        PositionDatabase(const PositionDatabase &) = delete;
+        PositionDatabase &operator=(const PositionDatabase &) = delete;
+        ~PositionDatabase();
+
+        /**
+         * @brief
+         * Creates an empty database, replacing any file at the path, and
+         * opens it for writing.
+         * @param capacity
+         * Number of records to make room for before the file first grows.
+         * @return
+         * False if the file could not be created or mapped.
+         */
+        bool create(const std::string &path, std::size_t capacity);
+
+        /**
+         * @brief
+         * Opens an existing database.
+         * @param writable
+         * Whether positions may be added. A read-only database maps the
+         * file read-only and can be shared by any number of processes.
+         * @return
+         * False if the file could not be opened or is not a database.
+         */
+        bool open(const std::string &path, bool writable);
+
+        /**
+         * @brief
+         * Unmaps and closes the file. Called by the destructor.
+         */
+        void close();
+
+        bool isOpen() const { return base != nullptr; }
+        bool isWritable() const { return writable; }
+
+        /**
+         * @return
+         * Number of distinct positions stored.
+         */
+        std::size_t size() const;
+
+        /**
+         * @return
+         * The stored records, in the order they were added, size() of
+         * them. Invalidated when the file grows, by add here or by
+         * another process before a later call.
+         */
+        const PositionRecord *records() const;
+
+        /**
+         * @brief
+         * Looks up a position by key alone, for "have we seen this
+         * position" queries that do not need to rule out key collisions.
+         * @return
+         * The first record with the key, or nullptr. Invalidated when add
+         * grows the file.
+         */
+        const PositionRecord *find(std::uint64_t key) const;
+
+        /**
+         * @brief
+         * Looks up a position, comparing the packed records as well as
+         * the key.
+         * @return
+         * Its record, or nullptr. Invalidated when add grows the file.
+         */
+        const PositionRecord *find(const PackedPosition &position) const;
+        const PositionRecord *find(const PackedPosition &position, std::uint64_t key) const;
+
+        /**
+         * @brief
+         * Records one more occurrence of a position, adding it if it is new.
+         * @param result
+         * Outcome of the game it occurred in; ResultUnknown counts no result.
+         * @param bestMove
+         * Replaces the stored best move unless it is Move::none().
+         * @return
+         * False if the database is not writable or the file could not grow.
+         */
+        bool add(const PackedPosition &position, GameResult result, Move bestMove = Move::none());
+        bool add(const PackedPosition &position, std::uint64_t key, GameResult result, Move bestMove = Move::none());
+
+        /**
+         * @brief
+         * Flushes the mapped file to disk.
+         * @return
+         * False if the flush failed.
+         */
+        bool sync();
+
+    private:
+        /**
+         * @brief
+         * find with the generation check: probes, and remaps and probes
+         * again if the file grew meanwhile. A null position matches by key.
+         */
+        const PositionRecord *lookup(const PackedPosition *position, std::uint64_t key) const;
+
+        /**
+         * @return
+         * The record number (from 1) of the position, or 0 if absent or if
+         * the index holds a number past the records of this mapping; slot
+         * receives the slot holding it or the empty slot ending the probe.
+         * A null position matches any record with the key.
+         */
+        std::uint64_t probe(const PackedPosition *position, std::uint64_t key, std::uint64_t &slot) const;
+
+        /**
+         * @brief
+         * Extends the file so it holds newCapacity records and an index of
+         * newSlots slots, and rebuilds the index.
+         */
+        bool grow(std::uint64_t newCapacity, std::uint64_t newSlots);
+
+        /**
+         * @brief
+         * Maps the whole file, checks its header and caches its layout.
+         */
+        bool attach() const;
+
+        /**
+         * @brief
+         * Maps the file again after another process grew it.
+         */
+        bool remap() const;
+
+        /**
+         * @return
+         * True if the mapping has the current layout, remapping it first
+         * if the file grew; false if it could not be remapped.
+         */
+        bool isCurrent() const;
+
+        bool map(std::size_t bytes) const;
+        void unmap() const;
+
+        int fd = -1;
+        bool writable = false;
+        // The mapping and its layout change when lookups follow a growth by another process
+        mutable unsigned char *base = nullptr;
+        mutable std::size_t mappedBytes = 0;
+        /** Layout of the mapping, cached so a file grown by another process is never overrun. */
+        mutable std::uint64_t recordCapacity = 0;
+        mutable std::uint64_t indexSlots = 0;
+        /** Header generation the cached layout belongs to. */
+        mutable std::uint64_t generation = 0;
+    };
+}
+
+#endif
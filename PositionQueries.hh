@@ -0,0 +1,78 @@
+#ifndef __POSITIONQUERIES_H__
+#define __POSITIONQUERIES_H__
+
+#include "Position.hh"
+
+namespace Student
+{
+    /**
+     * @brief
+     * The board queries of ChessBoard in row and column terms, answered
+     * from a bitboard position alone. They only read the position, so
+     * any number of threads may run them on one position as long as no
+     * thread modifies it.
+     */
+    namespace queries
+    {
+        template <class Position>
+        bool contains(const Position &pos, int row, int column)
+        {
+            const auto &geo = pos.geometry();
+            return row >= 0 && row < geo.rows() && column >= 0 && column < geo.cols();
+        }
+
+        /**
+         * @return
+         * True if the piece on the first square may legally move to the
+         * second, whoever's turn it is.
+         */
+        template <class Position>
+        bool isValidMove(const Position &pos, int fromRow, int fromColumn, int toRow, int toColumn)
+        {
+            if (!contains(pos, fromRow, fromColumn) || !contains(pos, toRow, toColumn))
+            {
+                return false;
+            }
+            const auto &geo = pos.geometry();
+            return pos.isLegal(geo.square(fromRow, fromColumn), geo.square(toRow, toColumn));
+        }
+
+        /**
+         * @return
+         * True if a piece of the opponent of color attacks the square,
+         * which must be empty or hold a piece of color.
+         */
+        template <class Position>
+        bool isSquareUnderAttack(const Position &pos, int row, int column, Color color)
+        {
+            if (!contains(pos, row, column))
+            {
+                return false;
+            }
+            int square = pos.geometry().square(row, column);
+            // A piece cannot attack a square held by its own side
+            if (!pos.isEmpty(square) && pos.colorAt(square) != color)
+            {
+                return false;
+            }
+            return pos.isAttackedBy(square, opponent(color));
+        }
+
+        /**
+         * @return
+         * True if a piece stands on the square and an opponent piece attacks it.
+         */
+        template <class Position>
+        bool isPieceUnderThreat(const Position &pos, int row, int column)
+        {
+            if (!contains(pos, row, column))
+            {
+                return false;
+            }
+            int square = pos.geometry().square(row, column);
+            return !pos.isEmpty(square) && pos.isAttackedBy(square, opponent(pos.colorAt(square)));
+        }
+    }
+}
+
+#endif
@@ -1,41 +1,14 @@
 #include "RookPiece.hh"
-#include "ChessBoard.hh"
+#include "PieceRules.hh"
 
 namespace Student {
 
     RookPiece::RookPiece(ChessBoard &board, Color color, int row, int column, Type type)
-        : ChessPiece(board, color, row, column, type) {}
+        : ChessPiece(board, color, row, column, type) { standardRules = true; }
 
-    bool RookPiece::canMoveToLocation(int toRow, int toColumn) 
+    bool RookPiece::canMoveToLocation(int toRow, int toColumn)
     {
-        int rowDiff = std::abs(getRow() - toRow);
-        int colDiff = std::abs(getColumn() - toColumn);
-
-        if (rowDiff == 0 || colDiff == 0) 
-        {
-            int rowStep = (toRow > getRow()) ? 1 : (toRow < getRow()) ? -1 : 0;
-            int colStep = (toColumn > getColumn()) ? 1 : (toColumn < getColumn()) ? -1 : 0;
-
-            int r = getRow() + rowStep;
-            int c = getColumn() + colStep;
-            while (r != toRow || c != toColumn) 
-            {
-                if (board.getPiece(r, c) != nullptr) 
-                {
-                    return false;
-                }
-                r += rowStep;
-                c += colStep;
-            }
-
-            ChessPiece *targetPiece = board.getPiece(toRow, toColumn);
-            if (targetPiece == nullptr || targetPiece->getColor() != getColor()) 
-            {
-                return true;
-            }
-        }
-
-        return false;
+        return PieceRules<Rook>::canMoveToLocation(*this, toRow, toColumn);
     }
 
     const char *RookPiece::toString() 
@@ -9,7 +9,7 @@
  */
 namespace Student
 {
-    class RookPiece : public ChessPiece
+    class RookPiece final : public ChessPiece
     {
     public:
         RookPiece(ChessBoard &board, Color color, int row, int column, Type type);
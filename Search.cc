@@ -0,0 +1,416 @@
+#include "Search.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace Student
+{
+    namespace
+    {
+        constexpr int maxPly = 128;
+        constexpr int infinity = mateScore + 1;
+
+        using evaluation::pieceValues;
+
+        // Move ordering tiers
+        constexpr int tableMoveScore = 1 << 20;
+        constexpr int captureScore = 1 << 16;
+        constexpr int killerScore = captureScore - 2;
+
+        // Mate scores are stored relative to the node so an entry stays
+        // correct when the position is reached at a different ply
+        int scoreToTable(int score, int ply)
+        {
+            if (score >= mateThreshold)
+                return score + ply;
+            if (score <= -mateThreshold)
+                return score - ply;
+            return score;
+        }
+
+        int scoreFromTable(int score, int ply)
+        {
+            if (score >= mateThreshold)
+                return score - ply;
+            if (score <= -mateThreshold)
+                return score + ply;
+            return score;
+        }
+
+        template <class Position>
+        class Searcher
+        {
+        public:
+            using MoveList = typename Position::MoveList;
+
+            /**
+             * @param stop
+             * Set by the main thread when it finishes. Helpers stop on it
+             * unless a node limit gives them their own share to search.
+             * @param index
+             * Thread index, 0 for the main thread.
+             * @param threads
+             * Number of threads searching, which share the node limit.
+             */
+            Searcher(const Position &root, const SearchLimits &limits, TranspositionTable &table,
+                     const std::atomic<bool> &stop, int index, int threads)
+                : pos(root), limits(limits), table(table), stop(stop), start(std::chrono::steady_clock::now()),
+                  firstDepth(1 + index % 3), stopsWithMain(index != 0 && limits.maxNodes == 0), limited(index != 0)
+            {
+                // Each thread gets a fixed share of the node limit, so the
+                // total searched under a node limit does not depend on timing
+                if (limits.maxNodes != 0)
+                    nodeBudget = limits.maxNodes / threads + (std::uint64_t(index) < limits.maxNodes % threads ? 1 : 0);
+            }
+
+            SearchResult run()
+            {
+                SearchResult result;
+                keys[0] = pos.hash();
+                // Helpers start one or two plies deeper than the main thread,
+                // so they run ahead of it and fill the table with deeper results
+                for (int depth = firstDepth; depth <= limits.maxDepth && depth < maxPly; depth++)
+                {
+                    int score = negamax(depth, 0, -infinity, infinity);
+                    if (aborted)
+                        break;
+
+                    result.depth = depth;
+                    result.score = score;
+                    result.pv.assign(pv[0], pv[0] + pvLength[0]);
+                    result.bestMove = result.pv.empty() ? Move::none() : result.pv[0];
+
+                    // The main thread's limits only apply once it has a move
+                    limited = true;
+                    if (result.bestMove.isNone() || mateScore - std::abs(score) <= depth || outOfTime())
+                        break;
+                }
+                result.nodes = nodes;
+                result.seconds = elapsed();
+                return result;
+            }
+
+        private:
+            double elapsed() const
+            {
+                std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+                return seconds.count();
+            }
+
+            bool outOfTime() const
+            {
+                return limits.maxSeconds > 0 && elapsed() >= limits.maxSeconds;
+            }
+
+            /**
+             * @brief
+             * Counts a node and decides whether the search must stop.
+             * The clock is only read every 1024 nodes.
+             */
+            bool visitNode()
+            {
+                if (limited && (nodes >= nodeBudget || (stopsWithMain && stop.load(std::memory_order_relaxed))))
+                    aborted = true;
+                else if (limited && (nodes & 1023) == 0 && outOfTime())
+                    aborted = true;
+                else
+                    nodes++;
+                return aborted;
+            }
+
+            bool isRepetition(int ply) const
+            {
+                for (int i = ply - 2; i >= 0; i -= 2)
+                {
+                    if (keys[i] == keys[ply])
+                        return true;
+                }
+                return false;
+            }
+
+            int captureOrder(Move move) const
+            {
+                return captureScore + 8 * pieceValues[pos.typeAt(move.to())] / 10 - pieceValues[pos.typeAt(move.from())] / 100;
+            }
+
+            void scoreMoves(const MoveList &moves, int *scores, Move tableMove, int ply) const
+            {
+                for (int i = 0; i < moves.size(); i++)
+                {
+                    Move move = moves[i];
+                    if (move == tableMove)
+                        scores[i] = tableMoveScore;
+                    else if (!pos.isEmpty(move.to()))
+                        scores[i] = captureOrder(move);
+                    else if (move == killers[ply][0])
+                        scores[i] = killerScore;
+                    else if (move == killers[ply][1])
+                        scores[i] = killerScore - 1;
+                    else
+                        scores[i] = 0;
+                }
+            }
+
+            /**
+             * @brief
+             * Moves the best scored move of moves[index..] to index.
+             */
+            static void pickMove(MoveList &moves, int *scores, int index)
+            {
+                int best = index;
+                for (int i = index + 1; i < moves.size(); i++)
+                {
+                    if (scores[i] > scores[best])
+                        best = i;
+                }
+                std::swap(moves[index], moves[best]);
+                std::swap(scores[index], scores[best]);
+            }
+
+            void updatePv(int ply, Move move)
+            {
+                pv[ply][ply] = move;
+                for (int i = ply + 1; i < pvLength[ply + 1]; i++)
+                {
+                    pv[ply][i] = pv[ply + 1][i];
+                }
+                pvLength[ply] = pvLength[ply + 1];
+            }
+
+            int negamax(int depth, int ply, int alpha, int beta)
+            {
+                pvLength[ply] = ply;
+                if (ply > 0 && isRepetition(ply))
+                    return 0;
+                if (depth <= 0)
+                    return quiescence(ply, alpha, beta);
+                if (visitNode())
+                    return 0;
+                if (ply >= maxPly - 1)
+                    return evaluation::evaluate(pos);
+
+                bool pvNode = beta - alpha > 1;
+                Move tableMove = Move::none();
+                TTEntry entry;
+                if (table.probe(keys[ply], entry))
+                {
+                    tableMove = entry.move;
+                    int score = scoreFromTable(entry.score, ply);
+                    if (!pvNode && entry.depth >= depth &&
+                        (entry.bound == BoundExact ||
+                         (entry.bound == BoundLower && score >= beta) ||
+                         (entry.bound == BoundUpper && score <= alpha)))
+                    {
+                        return score;
+                    }
+                }
+
+                Color us = pos.sideToMove();
+                MoveList moves;
+                pos.generateLegalMoves(us, moves);
+                if (moves.empty())
+                    return pos.isInCheck(us) ? -mateScore + ply : 0;
+
+                int scores[MoveList::capacity];
+                scoreMoves(moves, scores, tableMove, ply);
+
+                int originalAlpha = alpha;
+                int bestScore = -infinity;
+                Move bestMove = Move::none();
+                for (int i = 0; i < moves.size(); i++)
+                {
+                    pickMove(moves, scores, i);
+                    Move move = moves[i];
+                    bool quiet = pos.isEmpty(move.to());
+                    table.prefetch(pos.hashAfter(move));
+
+                    MoveUndo undo;
+                    pos.makeMove(move, undo);
+                    keys[ply + 1] = pos.hash();
+                    int score;
+                    if (i == 0)
+                    {
+                        score = -negamax(depth - 1, ply + 1, -beta, -alpha);
+                    }
+                    else
+                    {
+                        // Later moves are assumed worse; re-search only if one proves better
+                        score = -negamax(depth - 1, ply + 1, -alpha - 1, -alpha);
+                        if (score > alpha && score < beta)
+                            score = -negamax(depth - 1, ply + 1, -beta, -alpha);
+                    }
+                    pos.unmakeMove(move, undo);
+                    if (aborted)
+                        return 0;
+
+                    if (score > bestScore)
+                    {
+                        bestScore = score;
+                        bestMove = move;
+                        if (score > alpha)
+                        {
+                            alpha = score;
+                            updatePv(ply, move);
+                        }
+                    }
+                    if (alpha >= beta)
+                    {
+                        if (quiet && move != killers[ply][0])
+                        {
+                            killers[ply][1] = killers[ply][0];
+                            killers[ply][0] = move;
+                        }
+                        break;
+                    }
+                }
+
+                Bound bound = bestScore >= beta ? BoundLower : bestScore > originalAlpha ? BoundExact : BoundUpper;
+                table.store(keys[ply], bestMove, scoreToTable(bestScore, ply), depth, bound);
+                return bestScore;
+            }
+
+            /**
+             * @brief
+             * Searches captures until the position is quiet. When in check
+             * every evasion is searched instead, so mates are not missed.
+             */
+            int quiescence(int ply, int alpha, int beta)
+            {
+                pvLength[ply] = ply;
+                if (visitNode())
+                    return 0;
+                if (ply >= maxPly - 1)
+                    return evaluation::evaluate(pos);
+
+                Color us = pos.sideToMove();
+                MoveList moves;
+                int bestScore;
+                if (pos.isInCheck(us))
+                {
+                    pos.generateLegalMoves(us, moves);
+                    if (moves.empty())
+                        return -mateScore + ply;
+                    bestScore = -infinity;
+                }
+                else
+                {
+                    bestScore = evaluation::evaluate(pos);
+                    if (bestScore >= beta)
+                        return bestScore;
+                    if (bestScore > alpha)
+                        alpha = bestScore;
+                    pos.generateLegalCaptures(us, moves);
+                }
+
+                int scores[MoveList::capacity];
+                scoreMoves(moves, scores, Move::none(), ply);
+                for (int i = 0; i < moves.size(); i++)
+                {
+                    pickMove(moves, scores, i);
+                    Move move = moves[i];
+                    MoveUndo undo;
+                    pos.makeMove(move, undo);
+                    int score = -quiescence(ply + 1, -beta, -alpha);
+                    pos.unmakeMove(move, undo);
+                    if (aborted)
+                        return 0;
+
+                    if (score > bestScore)
+                    {
+                        bestScore = score;
+                        if (score > alpha)
+                            alpha = score;
+                    }
+                    if (alpha >= beta)
+                        break;
+                }
+                return bestScore;
+            }
+
+            Position pos;
+            const SearchLimits &limits;
+            TranspositionTable &table;
+            const std::atomic<bool> &stop;
+            std::chrono::steady_clock::time_point start;
+            int firstDepth;
+            // Under a node limit a helper searches its whole share, so how
+            // far it gets does not depend on when the main thread finishes
+            bool stopsWithMain;
+            // Counted per thread in the thread's own searcher and summed at
+            // the end, so threads never write to a shared counter
+            std::uint64_t nodes = 0;
+            std::uint64_t nodeBudget = UINT64_MAX;
+            bool limited;
+            bool aborted = false;
+
+            // Keys of the positions on the current path, for repetitions
+            std::uint64_t keys[maxPly + 1];
+            // Triangular principal variation table
+            Move pv[maxPly][maxPly];
+            int pvLength[maxPly];
+            Move killers[maxPly][2] = {};
+        };
+    }
+
+    template <class Position>
+    SearchResult searchPosition(const Position &position, const SearchLimits &limits, TranspositionTable &table)
+    {
+        auto start = std::chrono::steady_clock::now();
+        table.newSearch();
+
+        // Every thread searches its own copy of the position; the searchers
+        // hold large per-ply tables, so keep them off the stack
+        int threads = std::max(1, limits.threads);
+        std::atomic<bool> stop(false);
+        std::vector<std::unique_ptr<Searcher<Position>>> searchers;
+        for (int i = 0; i < threads; i++)
+        {
+            searchers.push_back(std::make_unique<Searcher<Position>>(position, limits, table, stop, i, threads));
+        }
+
+        std::vector<SearchResult> results(threads);
+        std::vector<std::thread> helpers;
+        for (int i = 1; i < threads; i++)
+        {
+            helpers.emplace_back([&, i]() { results[i] = searchers[i]->run(); });
+        }
+        results[0] = searchers[0]->run();
+        stop.store(true, std::memory_order_relaxed);
+        for (std::thread &helper : helpers)
+        {
+            helper.join();
+        }
+
+        // A helper that completed a deeper iteration than the main thread
+        // supplies the move
+        SearchResult result = std::move(results[0]);
+        for (int i = 1; i < threads; i++)
+        {
+            if (results[i].depth > result.depth && !results[i].bestMove.isNone())
+            {
+                result.bestMove = results[i].bestMove;
+                result.score = results[i].score;
+                result.depth = results[i].depth;
+                result.pv = std::move(results[i].pv);
+            }
+            result.nodes += results[i].nodes;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        result.seconds = elapsed.count();
+        return result;
+    }
+
+    template SearchResult searchPosition<StandardPosition>(const StandardPosition &, const SearchLimits &, TranspositionTable &);
+    template SearchResult searchPosition<NarrowPosition>(const NarrowPosition &, const SearchLimits &, TranspositionTable &);
+    template SearchResult searchPosition<WidePosition>(const WidePosition &, const SearchLimits &, TranspositionTable &);
+
+    SearchResult search(ChessBoard &board, const SearchLimits &limits, TranspositionTable &table)
+    {
+        return board.withPosition([&](const auto &pos) { return searchPosition(pos, limits, table); });
+    }
+}
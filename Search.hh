@@ -0,0 +1,94 @@
+#ifndef __SEARCH_H__
+#define __SEARCH_H__
+
+#include "ChessBoard.hh"
+#include "TranspositionTable.hh"
+
+#include <cstdint>
+#include <vector>
+
+namespace Student
+{
+    /**
+     * @brief
+     * Score of a position where the side to move is checkmated. A mate
+     * found n plies from the root scores mateScore - n for the winner.
+     */
+    constexpr int mateScore = 32000;
+
+    /**
+     * @brief
+     * Scores beyond this magnitude announce a forced mate.
+     */
+    constexpr int mateThreshold = mateScore - 1000;
+
+    /**
+     * @brief
+     * Hard limits for a search. A limit of 0 means no limit.
+     * The search always completes depth 1, so it returns a move whenever
+     * one exists.
+     */
+    struct SearchLimits
+    {
+        int maxDepth = 64;
+        /** Total over all threads; each thread gets an equal share. */
+        std::uint64_t maxNodes = 0;
+        double maxSeconds = 0;
+        /** Number of search threads sharing the transposition table. */
+        int threads = 1;
+    };
+
+    /**
+     * @brief
+     * Result of the deepest completed iteration of a search.
+     */
+    struct SearchResult
+    {
+        /** Move::none() if the side to move has no legal move. */
+        Move bestMove = Move::none();
+        /** Centipawns from the point of view of the side to move. */
+        int score = 0;
+        int depth = 0;
+        /** Principal variation, starting with bestMove. */
+        std::vector<Move> pv;
+        /** Nodes searched by all threads. */
+        std::uint64_t nodes = 0;
+        double seconds = 0;
+    };
+
+    /**
+     * @brief
+     * Iterative deepening negamax alpha-beta search with a principal
+     * variation search, a capture-only quiescence search and the
+     * transposition table for cutoffs and move ordering.
+     *
+     * With more than one thread the search runs Lazy SMP: every thread
+     * searches its own copy of the position and they cooperate only
+     * through the shared table. The calling thread is the main thread.
+     * Under a node limit every thread stops at its own share of it;
+     * otherwise the helpers stop when the main thread finishes.
+     *
+     * Only a single-threaded search is deterministic: the same position,
+     * limits and table contents always give the same result. With more
+     * threads, what each thread finds in the shared table depends on
+     * timing, so the move, score, depth and node count may differ from
+     * run to run, even under a node limit.
+     * @param position
+     * The position to search, with its side to move. Not modified.
+     * @param limits
+     * Depth, node and time limits.
+     * @param table
+     * Transposition table to read and fill.
+     */
+    template <class Position>
+    SearchResult searchPosition(const Position &position, const SearchLimits &limits, TranspositionTable &table);
+
+    /**
+     * @brief
+     * Searches the board's current position for the side whose turn it is.
+     * The board is not modified.
+     */
+    SearchResult search(ChessBoard &board, const SearchLimits &limits, TranspositionTable &table);
+}
+
+#endif
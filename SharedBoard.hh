@@ -0,0 +1,73 @@
+#ifndef __SHAREDBOARD_H__
+#define __SHAREDBOARD_H__
+
+#include "ChessBoard.hh"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace Student
+{
+    /**
+     * @brief
+     * Publishes the positions of a board that one thread plays on to any
+     * number of reader threads, read-copy-update style.
+     *
+     * The writer plays on its own ChessBoard and calls publish after each
+     * change; publishing swaps in a new immutable snapshot with an atomic
+     * shared_ptr store. Readers call read to get the current snapshot and
+     * query it for as long as they hold it, without ever seeing a
+     * half-made move. A snapshot is freed when the last reader holding it
+     * lets go.
+     *
+     * publish and read are not lock-free: the atomic shared_ptr functions
+     * guard the pointer copy and its reference count with a small mutex
+     * from the standard library's lock pool. That lock is held only for
+     * the copy; the queries on a snapshot a reader holds take no locks,
+     * so readers should read once per batch of queries, not per query.
+     */
+    class SharedBoard
+    {
+    public:
+        using Snapshot = std::shared_ptr<const BoardSnapshot>;
+
+        explicit SharedBoard(const ChessBoard &board) : current(std::make_shared<const BoardSnapshot>(board.snapshot())) {}
+
+        SharedBoard(const SharedBoard &) = delete;
+        SharedBoard &operator=(const SharedBoard &) = delete;
+
+        /**
+         * @brief
+         * Makes the board's current position the one readers see.
+         * Safe to call concurrently with read, not with another publish.
+         */
+        void publish(const ChessBoard &board) { publish(board.snapshot()); }
+        void publish(const BoardSnapshot &snapshot)
+        {
+            std::atomic_store_explicit(&current, std::make_shared<const BoardSnapshot>(snapshot), std::memory_order_release);
+            version.fetch_add(1, std::memory_order_release);
+        }
+
+        /**
+         * @return
+         * The last published position. It stays valid and unchanged for
+         * as long as the caller holds it, whatever is published meanwhile.
+         * Briefly takes the lock that guards the shared pointer.
+         */
+        Snapshot read() const { return std::atomic_load_explicit(&current, std::memory_order_acquire); }
+
+        /**
+         * @return
+         * Number of publish calls so far, so readers can tell cheaply
+         * whether a snapshot they hold is still current.
+         */
+        std::uint64_t getVersion() const { return version.load(std::memory_order_acquire); }
+
+    private:
+        Snapshot current;
+        std::atomic<std::uint64_t> version{0};
+    };
+}
+
+#endif
@@ -0,0 +1,148 @@
+#include "ThreadPool.hh"
+
+namespace Student
+{
+    namespace
+    {
+        // The pool and worker index of the calling thread, if it is a worker
+        thread_local const ThreadPool *currentPool = nullptr;
+        thread_local int currentWorker = -1;
+    }
+
+    ThreadPool::ThreadPool(int threads)
+    {
+        int count = threads < 1 ? 1 : threads;
+        for (int i = 0; i < count; i++)
+        {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        for (int i = 0; i < count; i++)
+        {
+            workers.emplace_back(&ThreadPool::work, this, i);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        wait();
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            stopping = true;
+        }
+        workAvailable.notify_all();
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::submit(Task task)
+    {
+        std::size_t target = currentPool == this ? std::size_t(currentWorker)
+                                                 : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        unfinished.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(queues[target]->mutex);
+            queues[target]->tasks.push_back(std::move(task));
+        }
+        // Only count the task as queued once a worker can find it. Paired
+        // with the sleeping count in work: either the worker sees the task
+        // before it sleeps, or this sees the sleeper and wakes it
+        queued.fetch_add(1, std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_seq_cst) > 0)
+        {
+            // Taking the mutex orders the notify after a sleeper's last check
+            std::lock_guard<std::mutex> lock(stateMutex);
+            workAvailable.notify_one();
+        }
+    }
+
+    void ThreadPool::wait()
+    {
+        if (unfinished.load(std::memory_order_acquire) == 0)
+        {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(stateMutex);
+        allDone.wait(lock, [this]() { return unfinished.load(std::memory_order_acquire) == 0; });
+    }
+
+    bool ThreadPool::reserveTask()
+    {
+        std::size_t available = queued.load(std::memory_order_relaxed);
+        while (available > 0)
+        {
+            if (queued.compare_exchange_weak(available, available - 1, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ThreadPool::finishTask()
+    {
+        if (unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            allDone.notify_all();
+        }
+    }
+
+    bool ThreadPool::takeTask(int index, Task &task)
+    {
+        int count = int(queues.size());
+        for (int offset = 0; offset < count; offset++)
+        {
+            Queue &queue = *queues[(index + offset) % count];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty())
+            {
+                continue;
+            }
+            // Own work is taken newest first, stolen work oldest first
+            if (offset == 0)
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void ThreadPool::work(int index)
+    {
+        currentPool = this;
+        currentWorker = index;
+        while (true)
+        {
+            if (reserveTask())
+            {
+                // A queued task is reserved for this worker, so one is found
+                Task task;
+                while (!takeTask(index, task))
+                {
+                    std::this_thread::yield();
+                }
+                task(index);
+                finishTask();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(stateMutex);
+            sleeping.fetch_add(1, std::memory_order_seq_cst);
+            workAvailable.wait(lock, [this]() { return stopping || queued.load(std::memory_order_seq_cst) > 0; });
+            sleeping.fetch_sub(1, std::memory_order_relaxed);
+            if (stopping && queued.load(std::memory_order_relaxed) == 0)
+            {
+                return;
+            }
+        }
+    }
+}
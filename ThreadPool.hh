@@ -0,0 +1,99 @@
+#ifndef __THREADPOOL_H__
+#define __THREADPOOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Student
+{
+    /**
+     * @brief
+     * Fixed set of worker threads running submitted tasks.
+     *
+     * Every worker owns a deque of tasks. A worker takes the newest task
+     * from its own deque and, when that is empty, steals the oldest task
+     * from another worker's deque, so uneven tasks still keep every
+     * worker busy.
+     */
+    class ThreadPool
+    {
+    public:
+        /**
+         * @brief
+         * A task receives the index of the worker running it, in
+         * 0..getThreadCount() - 1, e.g. to pick per-worker state.
+         */
+        using Task = std::function<void(int)>;
+
+        /**
+         * @param threads
+         * Number of workers. Values below 1 count as 1.
+         */
+        explicit ThreadPool(int threads);
+
+        /**
+         * @brief
+         * Waits for every submitted task, then stops the workers.
+         */
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        int getThreadCount() const { return int(workers.size()); }
+
+        /**
+         * @brief
+         * Queues a task. Called from a worker, the task goes to that
+         * worker's own deque; otherwise the deques are filled in turn.
+         */
+        void submit(Task task);
+
+        /**
+         * @brief
+         * Blocks until every submitted task has finished. Must not be
+         * called from a task.
+         */
+        void wait();
+
+    private:
+        struct alignas(64) Queue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void work(int index);
+        bool takeTask(int index, Task &task);
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+
+        bool reserveTask();
+        void finishTask();
+
+        // The counters are atomic so submitting and running tasks take no
+        // lock but their queue's; the mutex only guards sleeping and waking
+        std::mutex stateMutex;
+        std::condition_variable workAvailable;
+        std::condition_variable allDone;
+        /** Tasks queued but not yet reserved by a worker. */
+        std::atomic<std::size_t> queued{0};
+        /** Tasks submitted but not yet finished. */
+        std::atomic<std::size_t> unfinished{0};
+        /** Workers blocked on workAvailable, so submit can skip the mutex when none is. */
+        std::atomic<int> sleeping{0};
+        std::atomic<std::size_t> nextQueue{0};
+        /** Guarded by stateMutex. */
+        bool stopping = false;
+    };
+}
+
+#endif
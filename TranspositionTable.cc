@@ -0,0 +1,136 @@
+#include "TranspositionTable.hh"
+
+namespace Student
+{
+    namespace
+    {
+        // Layout of an entry's data word
+        constexpr int scoreShift = 16;
+        constexpr int depthShift = 32;
+        constexpr int boundShift = 40;
+        constexpr int ageShift = 42;
+        constexpr int ageBits = 6;
+        constexpr int ageMask = (1 << ageBits) - 1;
+
+        Move unpackMove(std::uint64_t data) { return Move::fromRaw(std::uint16_t(data)); }
+        int unpackScore(std::uint64_t data) { return std::int16_t(data >> scoreShift); }
+        int unpackDepth(std::uint64_t data) { return std::int8_t(data >> depthShift); }
+        Bound unpackBound(std::uint64_t data) { return Bound((data >> boundShift) & 3); }
+        int unpackAge(std::uint64_t data) { return int(data >> ageShift) & ageMask; }
+    }
+
+    TranspositionTable::TranspositionTable(std::size_t megabytes)
+    {
+        resize(megabytes);
+    }
+
+    void TranspositionTable::resize(std::size_t megabytes)
+    {
+        std::size_t budget = megabytes * 1024 * 1024 / sizeof(Bucket);
+        std::size_t count = 1;
+        while (count * 2 <= budget)
+        {
+            count *= 2;
+        }
+        buckets.reset(new Bucket[count]);
+        bucketMask = count - 1;
+        clear();
+    }
+
+    void TranspositionTable::clear()
+    {
+        for (std::size_t i = 0; i <= bucketMask; i++)
+        {
+            for (Slot &slot : buckets[i].slots)
+            {
+                slot.check.store(0, std::memory_order_relaxed);
+                slot.data.store(0, std::memory_order_relaxed);
+            }
+        }
+        generation = 0;
+    }
+
+    void TranspositionTable::newSearch()
+    {
+        generation = (generation + 1) & ageMask;
+    }
+
+    std::uint64_t TranspositionTable::pack(Move move, int score, int depth, Bound bound, int age)
+    {
+        return std::uint64_t(move.raw()) |
+               (std::uint64_t(std::uint16_t(score)) << scoreShift) |
+               (std::uint64_t(std::uint8_t(depth)) << depthShift) |
+               (std::uint64_t(bound) << boundShift) |
+               (std::uint64_t(age) << ageShift);
+    }
+
+    bool TranspositionTable::probe(std::uint64_t key, TTEntry &entry) const
+    {
+        const Bucket &bucket = buckets[key & bucketMask];
+        for (const Slot &slot : bucket.slots)
+        {
+            std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+            std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+            if ((check ^ data) == key && unpackBound(data) != BoundNone)
+            {
+                entry.move = unpackMove(data);
+                entry.score = unpackScore(data);
+                entry.depth = unpackDepth(data);
+                entry.bound = unpackBound(data);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void TranspositionTable::store(std::uint64_t key, Move move, int score, int depth, Bound bound)
+    {
+        Bucket &bucket = buckets[key & bucketMask];
+        Slot *victim = nullptr;
+        int victimWorth = 0;
+        for (Slot &slot : bucket.slots)
+        {
+            std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+            std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+            if ((check ^ data) == key || unpackBound(data) == BoundNone)
+            {
+                if (move.isNone() && (check ^ data) == key)
+                {
+                    move = unpackMove(data);
+                }
+                victim = &slot;
+                break;
+            }
+            // Each search generation an entry has survived costs it 8 plies of depth
+            int staleness = (generation - unpackAge(data)) & ageMask;
+            int worth = unpackDepth(data) - 8 * staleness;
+            if (victim == nullptr || worth < victimWorth)
+            {
+                victim = &slot;
+                victimWorth = worth;
+            }
+        }
+
+        std::uint64_t data = pack(move, score, depth, bound, generation);
+        victim->data.store(data, std::memory_order_relaxed);
+        victim->check.store(key ^ data, std::memory_order_relaxed);
+    }
+
+    int TranspositionTable::hashfull() const
+    {
+        std::size_t sampled = bucketMask + 1 < 250 ? bucketMask + 1 : 250;
+        int used = 0;
+        for (std::size_t i = 0; i < sampled; i++)
+        {
+            for (const Slot &slot : buckets[i].slots)
+            {
+                std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+                if (unpackBound(data) != BoundNone && unpackAge(data) == generation)
+                {
+                    used++;
+                }
+            }
+        }
+        return int(used * 1000 / (sampled * bucketSize));
+    }
+}
@@ -0,0 +1,147 @@
+#ifndef __TRANSPOSITIONTABLE_H__
+#define __TRANSPOSITIONTABLE_H__
+
+#include "Move.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Student
+{
+    /**
+     * @brief
+     * How a stored score relates to the true score of the position.
+     */
+    enum Bound
+    {
+        BoundNone,
+        /** The true score is at most the stored score (fail low). */
+        BoundUpper,
+        /** The true score is at least the stored score (fail high). */
+        BoundLower,
+        BoundExact,
+    };
+
+    /**
+     * @brief
+     * Unpacked contents of a transposition table entry.
+     */
+    struct TTEntry
+    {
+        Move move;
+        int score;
+        int depth;
+        Bound bound;
+    };
+
+    /**
+     * @brief
+     * Fixed-size hash table of search results keyed by Zobrist key, safe
+     * to share between search threads without locks.
+     *
+     * The table is a power-of-two array of 64-byte buckets with four
+     * entries each. An entry is two 64-bit words: the packed data and the
+     * key XORed with the data. A probe only accepts an entry when the two
+     * words XOR back to the probed key, so an entry torn by a concurrent
+     * write is rejected instead of being misread.
+     *
+     * Within a bucket a store replaces the entry for the same key, else an
+     * empty entry, else the entry with the lowest depth, where entries
+     * from older searches count as shallower.
+     */
+    class TranspositionTable
+    {
+    public:
+        static constexpr int bucketSize = 4;
+
+        /**
+         * @param megabytes
+         * Memory budget. The table uses the largest power-of-two number
+         * of buckets that fits, and at least one bucket.
+         */
+        explicit TranspositionTable(std::size_t megabytes);
+
+        /**
+         * @brief
+         * Reallocates the table for a new memory budget, dropping every entry.
+         * Must not run concurrently with any other call.
+         */
+        void resize(std::size_t megabytes);
+
+        /**
+         * @brief
+         * Drops every entry. Must not run concurrently with any other call.
+         */
+        void clear();
+
+        /**
+         * @brief
+         * Starts a new search generation, making existing entries cheaper
+         * to replace. Call between searches, not while one is running.
+         */
+        void newSearch();
+
+        /**
+         * @brief
+         * Looks up a position.
+         * @param key
+         * Zobrist key of the position.
+         * @param entry
+         * Receives the stored data on a hit.
+         * @return
+         * True if an entry for the key was found.
+         */
+        bool probe(std::uint64_t key, TTEntry &entry) const;
+
+        /**
+         * @brief
+         * Stores a search result. A null move keeps the move already stored
+         * for the same key.
+         * @param score
+         * Score in the range of a signed 16-bit integer.
+         * @param depth
+         * Remaining depth of the search, in the range -128..127.
+         */
+        void store(std::uint64_t key, Move move, int score, int depth, Bound bound);
+
+        /**
+         * @brief
+         * Hints the CPU to load the bucket for a key, e.g. for the position
+         * after a move before the move is made.
+         */
+        void prefetch(std::uint64_t key) const
+        {
+            __builtin_prefetch(&buckets[key & bucketMask]);
+        }
+
+        std::size_t getBucketCount() const { return bucketMask + 1; }
+
+        /**
+         * @return
+         * Permille of sampled entries written during the current search.
+         */
+        int hashfull() const;
+
+    private:
+        struct Slot
+        {
+            std::atomic<std::uint64_t> check;
+            std::atomic<std::uint64_t> data;
+        };
+
+        struct alignas(64) Bucket
+        {
+            Slot slots[bucketSize];
+        };
+
+        static std::uint64_t pack(Move move, int score, int depth, Bound bound, int age);
+
+        std::unique_ptr<Bucket[]> buckets;
+        std::uint64_t bucketMask = 0;
+        int generation = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef __ZOBRIST_H__
+#define __ZOBRIST_H__
+
+#include "Bitboard.hh"
+
+#include <cstdint>
+
+namespace Student
+{
+    /**
+     * @brief
+     * Castling rights of a position, one bit per king side and colour.
+     * Left castling moves the king towards column 0, right castling
+     * towards the last column.
+     */
+    enum CastlingRight
+    {
+        WhiteLeft = 1,
+        WhiteRight = 2,
+        BlackLeft = 4,
+        BlackRight = 8,
+    };
+
+    /**
+     * @brief
+     * Random keys for Zobrist hashing. A position's key is the XOR of
+     * the key of every (piece code, square) pair on the board, the key of
+     * its castling rights, and the side key when Black is to move.
+     */
+    struct ZobristKeys
+    {
+        static constexpr int pieceCodes = 9;
+        static constexpr int squares = BitboardTraits<WideBitboard>::capacity;
+
+        std::uint64_t piece[pieceCodes][squares];
+        std::uint64_t castling[16];
+        std::uint64_t side;
+    };
+
+    namespace zobrist
+    {
+        /**
+         * @brief
+         * splitmix64 step, used to fill the tables deterministically.
+         */
+        constexpr std::uint64_t nextRandom(std::uint64_t &state)
+        {
+            std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        constexpr ZobristKeys makeKeys()
+        {
+            ZobristKeys keys{};
+            std::uint64_t state = 0x5EED2024C0FFEEULL;
+            for (int code = 1; code < ZobristKeys::pieceCodes; code++)
+            {
+                for (int square = 0; square < ZobristKeys::squares; square++)
+                {
+                    keys.piece[code][square] = nextRandom(state);
+                }
+            }
+            for (int rights = 1; rights < 16; rights++)
+            {
+                keys.castling[rights] = nextRandom(state);
+            }
+            keys.side = nextRandom(state);
+            return keys;
+        }
+
+        inline constexpr ZobristKeys keys = makeKeys();
+    }
+}
+
+#endif
@@ -0,0 +1,58 @@
+// Board dimension limits of ChessBoard.
+// Build with the library sources, e.g.
+// g++ -std=c++17 -O2 -pthread *.cc tests/BoardSizeTest.cc -o board_size_test
+
+#include "../ChessBoard.hh"
+
+#include <cstdio>
+#include <stdexcept>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool condition, const char *what)
+    {
+        if (!condition)
+        {
+            std::printf("FAIL: %s\n", what);
+            failures++;
+        }
+    }
+
+    bool rejects(int numRows, int numCols)
+    {
+        try
+        {
+            Student::ChessBoard board(numRows, numCols);
+        }
+        catch (const std::invalid_argument &)
+        {
+            return true;
+        }
+        return false;
+    }
+}
+
+int main()
+{
+    expect(rejects(17, 17), "a 17x17 board is rejected");
+    expect(rejects(1, 257), "a 1x257 board is rejected");
+    expect(rejects(0, 8), "a board without rows is rejected");
+    expect(rejects(8, -1), "a board with negative columns is rejected");
+
+    // The largest boards of each position type still work
+    Student::ChessBoard wide(16, 16);
+    wide.createChessPiece(White, King, 15, 8);
+    wide.createChessPiece(Black, King, 0, 8);
+    wide.createChessPiece(White, Rook, 15, 15);
+    expect(wide.isValidMove(15, 15, 0, 15), "a rook crosses a 16x16 board");
+    expect(!rejects(1, 256), "a 1x256 board is accepted");
+    expect(!rejects(8, 8), "an 8x8 board is accepted");
+
+    if (failures == 0)
+    {
+        std::printf("board size checks passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,281 @@
+// Recomputes the counts of perftSuite with a separate, deliberately simple
+// move generator that shares no code with the library: a character per
+// square, rules written out square by square, and legality checked by
+// making each move and looking for an attack on the mover's king.
+// Build with the library sources, e.g.
+// g++ -std=c++17 -O2 -pthread *.cc tests/PerftReferenceTest.cc -o perft_reference_test
+
+#include "../Perft.hh"
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    struct Board
+    {
+        int rows;
+        int cols;
+        /** 'P', 'R', 'B', 'K' for White, lower case for Black, '.' for empty. */
+        std::vector<char> squares;
+        /** Set once the piece on a square has moved; every piece starts unmoved. */
+        std::vector<bool> moved;
+        bool whiteToMove = true;
+
+        char at(int row, int col) const { return squares[row * cols + col]; }
+        bool inside(int row, int col) const { return row >= 0 && row < rows && col >= 0 && col < cols; }
+    };
+
+    struct RefMove
+    {
+        int fromRow, fromCol, toRow, toCol;
+    };
+
+    bool isWhite(char piece) { return std::isupper(static_cast<unsigned char>(piece)) != 0; }
+
+    bool belongsTo(char piece, bool white) { return piece != '.' && isWhite(piece) == white; }
+
+    /** True if a piece of the given side attacks the square. */
+    bool attacked(const Board &board, int row, int col, bool byWhite)
+    {
+        for (int r = 0; r < board.rows; r++)
+        {
+            for (int c = 0; c < board.cols; c++)
+            {
+                char piece = board.at(r, c);
+                if (!belongsTo(piece, byWhite))
+                {
+                    continue;
+                }
+                int dr = row - r;
+                int dc = col - c;
+                switch (std::toupper(static_cast<unsigned char>(piece)))
+                {
+                case 'P':
+                    if (dr == (byWhite ? -1 : 1) && std::abs(dc) == 1)
+                        return true;
+                    break;
+                case 'K':
+                    if (std::abs(dr) <= 1 && std::abs(dc) <= 1 && (dr != 0 || dc != 0))
+                        return true;
+                    break;
+                case 'R':
+                case 'B':
+                {
+                    bool straight = (dr == 0) != (dc == 0);
+                    bool diagonal = dr != 0 && std::abs(dr) == std::abs(dc);
+                    if (std::toupper(static_cast<unsigned char>(piece)) == 'R' ? !straight : !diagonal)
+                        break;
+                    int stepR = (dr > 0) - (dr < 0);
+                    int stepC = (dc > 0) - (dc < 0);
+                    int rr = r + stepR;
+                    int cc = c + stepC;
+                    while ((rr != row || cc != col) && board.at(rr, cc) == '.')
+                    {
+                        rr += stepR;
+                        cc += stepC;
+                    }
+                    if (rr == row && cc == col)
+                        return true;
+                    break;
+                }
+                }
+            }
+        }
+        return false;
+    }
+
+    void addIfLandable(const Board &board, std::vector<RefMove> &moves, int r, int c, int toRow, int toCol, bool white)
+    {
+        if (board.inside(toRow, toCol) && !belongsTo(board.at(toRow, toCol), white))
+            moves.push_back({r, c, toRow, toCol});
+    }
+
+    /** Every move of the side to move that follows its piece's rules, castling included. */
+    std::vector<RefMove> pseudoLegalMoves(const Board &board)
+    {
+        std::vector<RefMove> moves;
+        bool white = board.whiteToMove;
+        for (int r = 0; r < board.rows; r++)
+        {
+            for (int c = 0; c < board.cols; c++)
+            {
+                char piece = board.at(r, c);
+                if (!belongsTo(piece, white))
+                {
+                    continue;
+                }
+                switch (std::toupper(static_cast<unsigned char>(piece)))
+                {
+                case 'P':
+                {
+                    int forward = white ? -1 : 1;
+                    int startRow = white ? board.rows - 2 : 1;
+                    if (board.inside(r + forward, c) && board.at(r + forward, c) == '.')
+                    {
+                        moves.push_back({r, c, r + forward, c});
+                        if (r == startRow && board.inside(r + 2 * forward, c) && board.at(r + 2 * forward, c) == '.')
+                            moves.push_back({r, c, r + 2 * forward, c});
+                    }
+                    for (int side : {-1, 1})
+                    {
+                        if (board.inside(r + forward, c + side) && belongsTo(board.at(r + forward, c + side), !white))
+                            moves.push_back({r, c, r + forward, c + side});
+                    }
+                    break;
+                }
+                case 'R':
+                case 'B':
+                {
+                    bool rook = std::toupper(static_cast<unsigned char>(piece)) == 'R';
+                    for (int dr = -1; dr <= 1; dr++)
+                    {
+                        for (int dc = -1; dc <= 1; dc++)
+                        {
+                            if ((dr == 0 && dc == 0) || (rook ? (dr != 0 && dc != 0) : (dr == 0 || dc == 0)))
+                                continue;
+                            int rr = r + dr;
+                            int cc = c + dc;
+                            while (board.inside(rr, cc) && board.at(rr, cc) == '.')
+                            {
+                                moves.push_back({r, c, rr, cc});
+                                rr += dr;
+                                cc += dc;
+                            }
+                            addIfLandable(board, moves, r, c, rr, cc, white);
+                        }
+                    }
+                    break;
+                }
+                case 'K':
+                {
+                    for (int dr = -1; dr <= 1; dr++)
+                    {
+                        for (int dc = -1; dc <= 1; dc++)
+                        {
+                            if (dr != 0 || dc != 0)
+                                addIfLandable(board, moves, r, c, r + dr, c + dc, white);
+                        }
+                    }
+                    if (board.moved[r * board.cols + c])
+                        break;
+                    // Two columns towards an unmoved rook of the same colour in the corner of the row
+                    for (int side : {-1, 1})
+                    {
+                        int toCol = c + 2 * side;
+                        int rookCol = side < 0 ? 0 : board.cols - 1;
+                        if (!board.inside(r, toCol) || board.at(r, toCol) != '.')
+                            continue;
+                        char rook = board.at(r, rookCol);
+                        if (std::toupper(static_cast<unsigned char>(rook)) != 'R' || !belongsTo(rook, white) ||
+                            board.moved[r * board.cols + rookCol])
+                            continue;
+                        bool clear = true;
+                        for (int col = c + side; col != rookCol; col += side)
+                            clear = clear && board.at(r, col) == '.';
+                        for (int col = c; clear && col != toCol + side; col += side)
+                            clear = !attacked(board, r, col, !white);
+                        if (clear)
+                            moves.push_back({r, c, r, toCol});
+                    }
+                    break;
+                }
+                }
+            }
+        }
+        return moves;
+    }
+
+    void play(Board &board, const RefMove &move)
+    {
+        int from = move.fromRow * board.cols + move.fromCol;
+        int to = move.toRow * board.cols + move.toCol;
+        char piece = board.squares[from];
+        if (std::toupper(static_cast<unsigned char>(piece)) == 'K' && std::abs(move.toCol - move.fromCol) == 2)
+        {
+            int side = move.toCol > move.fromCol ? 1 : -1;
+            int rookFrom = move.fromRow * board.cols + (side < 0 ? 0 : board.cols - 1);
+            int rookTo = to - side;
+            board.squares[rookTo] = board.squares[rookFrom];
+            board.squares[rookFrom] = '.';
+            board.moved[rookTo] = true;
+        }
+        board.squares[to] = piece;
+        board.squares[from] = '.';
+        board.moved[to] = true;
+        board.whiteToMove = !board.whiteToMove;
+    }
+
+    bool kingAttacked(const Board &board, bool white)
+    {
+        char king = white ? 'K' : 'k';
+        for (int r = 0; r < board.rows; r++)
+        {
+            for (int c = 0; c < board.cols; c++)
+            {
+                if (board.at(r, c) == king && attacked(board, r, c, !white))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    std::uint64_t referencePerft(const Board &board, int depth)
+    {
+        if (depth == 0)
+        {
+            return 1;
+        }
+        std::uint64_t nodes = 0;
+        for (const RefMove &move : pseudoLegalMoves(board))
+        {
+            Board next = board;
+            play(next, move);
+            if (!kingAttacked(next, board.whiteToMove))
+            {
+                nodes += referencePerft(next, depth - 1);
+            }
+        }
+        return nodes;
+    }
+
+    Board parseLayout(const Student::PerftCase &test)
+    {
+        Board board{test.numRows, test.numCols, {}, {}};
+        for (const char *c = test.layout; *c != '\0'; c++)
+        {
+            if (*c != '/')
+                board.squares.push_back(*c);
+        }
+        board.moved.assign(board.squares.size(), false);
+        return board;
+    }
+}
+
+int main()
+{
+    int failures = 0;
+    for (const Student::PerftCase &test : Student::perftSuite())
+    {
+        Board board = parseLayout(test);
+        for (std::size_t depth = 1; depth <= test.expected.size(); depth++)
+        {
+            std::uint64_t nodes = referencePerft(board, int(depth));
+            if (nodes != test.expected[depth - 1])
+            {
+                std::printf("FAIL: %s depth %zu: reference %llu, suite %llu\n", test.name, depth,
+                            static_cast<unsigned long long>(nodes),
+                            static_cast<unsigned long long>(test.expected[depth - 1]));
+                failures++;
+            }
+        }
+    }
+    if (failures == 0)
+    {
+        std::printf("perft suite matches the reference move generator\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
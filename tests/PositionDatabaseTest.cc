@@ -0,0 +1,150 @@
+// PositionDatabase growth and cross-instance lookups: a reader opened
+// before the writer grows the file must follow every growth, and the file
+// must reopen with everything in it.
+// Build with the library sources, e.g.
+// g++ -std=c++17 -O2 -pthread *.cc tests/PositionDatabaseTest.cc -o position_database_test
+
+#include "../Perft.hh"
+#include "../PositionDatabase.hh"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace Student;
+
+namespace
+{
+    const char *const databasePath = "position_database_test.db";
+
+    int failures = 0;
+
+    void expect(bool condition, const char *what)
+    {
+        if (!condition)
+        {
+            std::printf("FAIL: %s\n", what);
+            failures++;
+        }
+    }
+
+    /** Collects the distinct positions of a shallow game tree, in the order they are reached. */
+    template <class Position>
+    void collect(Position &pos, int depth, std::vector<PackedPosition> &positions, std::vector<std::uint64_t> &keys)
+    {
+        PackedPosition packed;
+        if (packPosition(pos, packed))
+        {
+            bool seen = false;
+            for (std::size_t i = 0; i < keys.size() && !seen; i++)
+            {
+                seen = keys[i] == pos.hash() && std::memcmp(&positions[i], &packed, sizeof(packed)) == 0;
+            }
+            if (!seen)
+            {
+                positions.push_back(packed);
+                keys.push_back(pos.hash());
+            }
+        }
+        if (depth == 0)
+        {
+            return;
+        }
+        typename Position::MoveList moves;
+        pos.generateLegalMoves(pos.sideToMove(), moves);
+        for (Move move : moves)
+        {
+            MoveUndo undo;
+            pos.makeMove(move, undo);
+            collect(pos, depth - 1, positions, keys);
+            pos.unmakeMove(move, undo);
+        }
+    }
+
+    /** True if every position is found by position and by key, with a record of the same key. */
+    bool findsAll(const PositionDatabase &db, const std::vector<PackedPosition> &positions, const std::vector<std::uint64_t> &keys)
+    {
+        for (std::size_t i = 0; i < positions.size(); i++)
+        {
+            const PositionRecord *record = db.find(positions[i]);
+            if (record == nullptr || record->key != keys[i] || db.find(keys[i]) == nullptr)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    std::vector<PackedPosition> positions;
+    std::vector<std::uint64_t> keys;
+    ChessBoard board(8, 8);
+    placePieces(board, perftSuite()[1].layout);
+    board.withPosition([&](const auto &pos) {
+        auto copy = pos;
+        collect(copy, 2, positions, keys);
+    });
+
+    // Room for two records, so the adds below grow the file several times
+    PositionDatabase writer;
+    expect(writer.create(databasePath, 2), "an empty database is created");
+    expect(writer.add(positions[0], keys[0], WhiteWin), "the first position is added");
+
+    PositionDatabase reader;
+    expect(reader.open(databasePath, false), "a second instance opens the database read-only");
+    expect(reader.size() == 1 && reader.find(positions[0]) != nullptr, "the reader sees the first position");
+    expect(!reader.add(positions[1], keys[1], Draw), "a read-only instance rejects adds");
+
+    for (std::size_t i = 1; i < positions.size(); i++)
+    {
+        writer.add(positions[i], keys[i], Draw);
+    }
+    writer.add(positions[0], keys[0], BlackWin, Move(1, 2));
+    expect(writer.size() == positions.size(), "every distinct position is stored once");
+
+    // Opened before any growth, the reader must remap to follow the writer
+    expect(reader.size() == positions.size(), "the reader sees the grown record count");
+    expect(findsAll(reader, positions, keys), "the reader finds every position added past the first capacity");
+    const PositionRecord *first = reader.find(positions[0]);
+    expect(first != nullptr && first->occurrences == 2 && first->whiteWins == 1 && first->blackWins == 1,
+           "a repeated position is counted, not stored again");
+    expect(first != nullptr && first->getBestMove() == Move(1, 2), "the best move is stored");
+
+    PackedPosition absent = positions[0];
+    absent.flags ^= PackedPosition::blackToMove;
+    expect(reader.find(absent) == nullptr, "a position with the same pieces but the other side to move is absent");
+
+    expect(writer.sync(), "the database is flushed");
+    writer.close();
+    reader.close();
+
+    PositionDatabase reopened;
+    expect(reopened.open(databasePath, true), "the database reopens for writing");
+    expect(reopened.size() == positions.size(), "the reopened database keeps its records");
+    expect(findsAll(reopened, positions, keys), "the reopened database finds every position");
+    std::uint64_t occurrences = 0;
+    for (std::size_t i = 0; i < reopened.size(); i++)
+    {
+        occurrences += reopened.records()[i].occurrences;
+    }
+    expect(occurrences == positions.size() + 1, "the records hold every occurrence");
+    reopened.close();
+
+    // A file that is not a database is refused
+    if (std::FILE *junk = std::fopen(databasePath, "wb"))
+    {
+        std::fputs("not a position database", junk);
+        std::fclose(junk);
+    }
+    PositionDatabase invalid;
+    expect(!invalid.open(databasePath, false), "a file without the database header is rejected");
+    std::remove(databasePath);
+
+    if (failures == 0)
+    {
+        std::printf("position database checks passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
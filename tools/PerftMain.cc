@@ -0,0 +1,160 @@
+#include "../Perft.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Student;
+
+namespace
+{
+    void printUsage()
+    {
+        std::printf("usage: perft [--divide] [parallel options] [case] [depth]\n"
+                    "       perft --suite [parallel options]\n"
+                    "Runs perft on a reference position (default: start, depth 4).\n"
+                    "Parallel options:\n"
+                    "  --threads N   run on N worker threads (0: all hardware threads)\n"
+                    "  --split N     split the tree into tasks after N plies (default 2)\n"
+                    "  --cache MB    share a perft cache of MB megabytes\n");
+    }
+
+    const PerftCase *findCase(const char *name)
+    {
+        for (const PerftCase &perftCase : perftSuite())
+        {
+            if (std::strcmp(perftCase.name, name) == 0)
+            {
+                return &perftCase;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief
+     * Runs perft serially, or in parallel when parallel is set.
+     */
+    PerftReport runMode(ChessBoard &board, int depth, bool divide, bool parallel, ParallelPerftOptions options)
+    {
+        if (!parallel)
+        {
+            return runPerft(board, depth, divide);
+        }
+        options.divide = divide;
+        ParallelPerftReport report = runParallelPerft(board, depth, options);
+        for (std::size_t i = 0; i < report.threadNodes.size(); i++)
+        {
+            std::printf("  thread %2zu  %12llu nodes  %8.3fs\n",
+                        i, (unsigned long long)report.threadNodes[i], report.threadSeconds[i]);
+        }
+        std::printf("  %zu tasks on %zu threads, efficiency %.1f%%\n",
+                    report.tasks, report.threadNodes.size(), report.efficiency * 100);
+        return report;
+    }
+
+    /**
+     * @brief
+     * Runs every reference position at every listed depth.
+     * @return
+     * Number of mismatching results.
+     */
+    int runSuite(bool parallel, const ParallelPerftOptions &options)
+    {
+        int failures = 0;
+        for (const PerftCase &perftCase : perftSuite())
+        {
+            for (std::size_t depth = 1; depth <= perftCase.expected.size(); depth++)
+            {
+                ChessBoard board(perftCase.numRows, perftCase.numCols);
+                placePieces(board, perftCase.layout);
+                PerftReport report = runMode(board, int(depth), false, parallel, options);
+                bool pass = report.nodes == perftCase.expected[depth - 1];
+                failures += pass ? 0 : 1;
+                std::printf("%-12s depth %zu  %12llu  %s  %8.3fs  %12.0f nps\n",
+                            perftCase.name, depth, (unsigned long long)report.nodes,
+                            pass ? "ok  " : "FAIL", report.seconds, report.nodesPerSecond);
+            }
+        }
+        std::printf("%s\n", failures == 0 ? "all perft results match" : "perft mismatches found");
+        return failures;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool divide = false;
+    bool suite = false;
+    bool parallel = false;
+    ParallelPerftOptions options;
+    const char *name = "start";
+    int depth = 4;
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--suite") == 0)
+        {
+            suite = true;
+        }
+        else if (std::strcmp(argv[i], "--divide") == 0)
+        {
+            divide = true;
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+        {
+            parallel = true;
+            options.threads = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--split") == 0 && hasValue)
+        {
+            parallel = true;
+            options.splitDepth = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--cache") == 0 && hasValue)
+        {
+            parallel = true;
+            options.cacheMegabytes = std::size_t(std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--help") == 0)
+        {
+            printUsage();
+            return EXIT_SUCCESS;
+        }
+        else if (argv[i][0] >= '0' && argv[i][0] <= '9')
+        {
+            depth = std::atoi(argv[i]);
+        }
+        else
+        {
+            name = argv[i];
+        }
+    }
+
+    if (suite)
+    {
+        return runSuite(parallel, options) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    const PerftCase *perftCase = findCase(name);
+    if (perftCase == nullptr)
+    {
+        std::printf("unknown position '%s'\n", name);
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    ChessBoard board(perftCase->numRows, perftCase->numCols);
+    placePieces(board, perftCase->layout);
+    PerftReport report = runMode(board, depth, divide, parallel, options);
+    for (const auto &entry : report.divide)
+    {
+        Move move = entry.first;
+        std::printf("%d,%d-%d,%d: %llu\n",
+                    move.from() / perftCase->numCols, move.from() % perftCase->numCols,
+                    move.to() / perftCase->numCols, move.to() % perftCase->numCols,
+                    (unsigned long long)entry.second);
+    }
+    std::printf("nodes %llu  time %.3fs  %.0f nps\n",
+                (unsigned long long)report.nodes, report.seconds, report.nodesPerSecond);
+    return EXIT_SUCCESS;
+}